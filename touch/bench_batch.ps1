@@ -0,0 +1,130 @@
+<#
+.SYNOPSIS
+  Times batch creation of touch on the in-memory backend with simulated latency.
+
+.DESCRIPTION
+  Runs touch --fs=memory --timings over generated file lists and prints the throughput
+  and concurrency touch reports for each run. Nothing is created on disk except the file
+  lists, in a temporary directory that is removed afterwards.
+
+  Scenarios:
+    controller  -j auto against fixed worker counts on three latency profiles
+    scaling     1 to 32 workers on one directory and on a wide tree, with a directory lock
+    async       64 worker threads against --async with 20000 files in flight, at 5 ms per operation
+    transaction batches with and without --transaction; fails if the journal costs more than 10%
+    serve       render requests piped through one touch --serve-stdio, including its start
+
+.EXAMPLE
+  touch\bench_batch.ps1 -Scenario controller
+#>
+param(
+  [string]$Touch = "$PSScriptRoot\..\bin\touch.exe",
+  [ValidateSet('controller', 'scaling', 'async', 'transaction', 'serve')]
+  [string]$Scenario = 'controller',
+  [int]$Files = 20000
+)
+
+$ErrorActionPreference = 'Stop'
+$work = Join-Path ([IO.Path]::GetTempPath()) "touch-bench-$PID"
+New-Item -ItemType Directory $work | Out-Null
+
+# Writes a list of $Count file names spread over $Directories directories.
+function New-FileList([int]$Count, [int]$Directories) {
+  $path = Join-Path $work "files-$Count-$Directories.txt"
+  if (-not (Test-Path $path)) {
+    $names = for ($i = 0; $i -lt $Count; $i++) { "d$($i % $Directories)\f$i.c" }
+    [IO.File]::WriteAllLines($path, [string[]]$names)
+  }
+  $path
+}
+
+# Runs touch on a file list and returns what --timings reports.
+function Measure-Batch([string]$Label, [string]$List, [string[]]$Options) {
+  $arguments = @('--fs=memory', '--timings', '-p', "--files-from=$List") + $Options
+  $report = & $Touch @arguments 2>&1 | ForEach-Object { "$_" }
+  if ($LASTEXITCODE -ne 0) { throw "touch $($arguments -join ' ') failed:`n$($report -join "`n")" }
+  $elapsed = $report | Select-String 'elapsed: ([\d.]+) s, (\d+) files/s' | Select-Object -First 1
+  $concurrency = $report | Select-String 'concurrency: (.*)' | Select-Object -First 1
+  [pscustomobject]@{
+    Run         = $Label
+    Options     = $Options -join ' '
+    Seconds     = [double]$elapsed.Matches[0].Groups[1].Value
+    FilesPerSec = [long]$elapsed.Matches[0].Groups[2].Value
+    Concurrency = if ($concurrency) { $concurrency.Matches[0].Groups[1].Value } else { '' }
+  }
+}
+
+try {
+  $results = @()
+  if ($Scenario -eq 'controller') {
+    $list = New-FileList $Files 1
+    $profiles = [ordered]@{
+      '2 ms, unlimited channels' = '--fs-latency=2000'
+      '1 ms, 8 channels'         = '--fs-latency=1000,0,0,8'
+      'no latency'               = '--fs-latency=0'
+    }
+    foreach ($name in $profiles.Keys) {
+      foreach ($jobs in @('auto', '8', '64')) {
+        $results += Measure-Batch $name $list @($profiles[$name], '-j', $jobs)
+      }
+    }
+  }
+  elseif ($Scenario -eq 'scaling') {
+    # 50 us per create, 50 us of it holding the parent directory's lock.
+    $workloads = [ordered]@{
+      'single dir (16k)' = New-FileList 16000 1
+      '500 dirs x 32'    = New-FileList 16000 500
+    }
+    foreach ($name in $workloads.Keys) {
+      foreach ($jobs in @(1, 2, 4, 8, 16, 32)) {
+        $results += Measure-Batch $name $workloads[$name] @('--fs-latency=50,0,0,0,50', '-j', "$jobs")
+      }
+    }
+  }
+  elseif ($Scenario -eq 'async') {
+    $list = New-FileList 50000 100
+    $results += Measure-Batch 'threads' $list @('--fs-latency=5000,5000', '-j', '64')
+    $results += Measure-Batch 'coroutines' $list @('--fs-latency=5000,5000', '--async=20000')
+  }
+  elseif ($Scenario -eq 'transaction') {
+    $list = New-FileList $Files 100
+    $overhead = @()
+    foreach ($mode in @(@('-j', '8'), @('-j', '1'), @('--async'))) {
+      $plain = Measure-Batch 'plain' $list (@('--fs-latency=50,20') + $mode)
+      $journaled = Measure-Batch 'transaction' $list (@('--fs-latency=50,20', '--transaction') + $mode)
+      $results += $plain, $journaled
+      $overhead += [pscustomobject]@{
+        Options  = $mode -join ' '
+        Overhead = [math]::Round(100 * ($journaled.Seconds / $plain.Seconds - 1), 1)
+      }
+    }
+    $results | Format-Table -AutoSize
+    $overhead | Format-Table -AutoSize
+    if ($overhead | Where-Object { $_.Overhead -gt 10 }) {
+      Write-Error 'The journal costs more than 10% of plain batch throughput'
+    }
+    return
+  }
+  elseif ($Scenario -eq 'serve') {
+    $requests = Join-Path $work 'requests.jsonl'
+    $lines = for ($i = 0; $i -lt $Files; $i++) { "{`"id`": $i, `"method`": `"render`", `"file`": `"f$i.c`"}" }
+    [IO.File]::WriteAllLines($requests, [string[]]$lines)
+    $responses = Join-Path $work 'responses.jsonl'
+    $watch = [Diagnostics.Stopwatch]::StartNew()
+    $process = Start-Process $Touch '--serve-stdio' -NoNewWindow -Wait -PassThru `
+      -RedirectStandardInput $requests -RedirectStandardOutput $responses
+    $watch.Stop()
+    $answered = @(Get-Content $responses | Select-String '"ok":true').Count
+    if ($process.ExitCode -ne 0 -or $answered -ne $Files) { throw "touch --serve-stdio answered $answered of $Files requests" }
+    $results += [pscustomobject]@{
+      Run          = 'serve-stdio render'
+      Requests     = $Files
+      Seconds      = [math]::Round($watch.Elapsed.TotalSeconds, 3)
+      MicrosPerReq = [math]::Round($watch.Elapsed.TotalMilliseconds * 1000 / $Files, 1)
+    }
+  }
+  $results | Format-Table -AutoSize
+}
+finally {
+  Remove-Item -Recurse -Force $work
+}
@@ -0,0 +1,96 @@
+<#
+.SYNOPSIS
+  Checks that every way touch renders a file gives byte-identical output.
+
+.DESCRIPTION
+  Renders one file per extension with touch --stdout and compares the bytes:
+    compiled   the configuration parsed and compiled by this run (--no-config-cache)
+    cached     the compiled configuration mapped from the cache file
+    built-in   the render functions generated by --emit-cpp into default_templates.hpp,
+               used without a touch.conf (only when checking the shipped touch.conf)
+    generated  a touch built with TOUCH_GENERATED_TEMPLATES from the configuration
+               (-Generated, optional)
+    reference  a touch built before the configuration was compiled, which renders from
+               the parsed configuration (-Reference, optional)
+  The extensions are those of the comment style table in touch.cpp and of the type
+  blocks of the configuration, plus an unknown extension and none at all. Every touch is
+  copied into a temporary directory of its own next to the configuration, so the
+  installed one is never read.
+
+  Outputs contain <date>, so don't run the check across midnight.
+
+.EXAMPLE
+  touch\check_render_paths.ps1 -Generated bin\touch-generated.exe
+#>
+param(
+  [string]$Touch = "$PSScriptRoot\..\bin\touch.exe",
+  [string]$Config = "$PSScriptRoot\touch.conf",
+  [string]$Reference = '',
+  [string]$Generated = ''
+)
+
+$ErrorActionPreference = 'Stop'
+$work = Join-Path ([IO.Path]::GetTempPath()) "touch-render-check-$PID"
+New-Item -ItemType Directory $work | Out-Null
+
+# Copies a touch into a directory of its own, with the configuration if one is given.
+function Install-Touch([string]$Name, [string]$Executable, [string]$Configuration) {
+  $directory = Join-Path $work $Name
+  New-Item -ItemType Directory $directory | Out-Null
+  Copy-Item $Executable (Join-Path $directory 'touch.exe')
+  if ($Configuration) { Copy-Item $Configuration (Join-Path $directory 'touch.conf') }
+  Join-Path $directory 'touch.exe'
+}
+
+# Returns the bytes touch renders for a file, as a hex string that compares exactly.
+function Get-Rendering([string]$Executable, [string[]]$Options, [string]$File) {
+  $output = Join-Path $work 'output.bin'
+  $arguments = $Options + @('--stdout', $File)
+  $process = Start-Process $Executable $arguments -NoNewWindow -Wait -PassThru -RedirectStandardOutput $output
+  if ($process.ExitCode -ne 0) { throw "$Executable $($arguments -join ' ') failed" }
+  [BitConverter]::ToString([IO.File]::ReadAllBytes($output))
+}
+
+try {
+  $extensions = @('', '.unknown-extension')
+  $extensions += Select-String -Path "$PSScriptRoot\touch.cpp" -Pattern '^\s*\{"(\.[^"]+)",\s*\{' |
+    ForEach-Object { $_.Matches[0].Groups[1].Value }
+  $extensions += Select-String -Path $Config -Pattern '^<type (\.\S+)>' |
+    ForEach-Object { $_.Matches[0].Groups[1].Value } | Where-Object { $_ -ne '.all' }
+  $extensions = $extensions | Sort-Object -Unique
+
+  $paths = [ordered]@{
+    compiled = @{ Executable = Install-Touch 'compiled' $Touch $Config; Options = @('--no-config-cache') }
+    cached   = @{ Executable = Install-Touch 'cached' $Touch $Config; Options = @() }
+  }
+  # default_templates.hpp is generated from the shipped touch.conf.
+  if ((Resolve-Path $Config).Path -eq (Resolve-Path "$PSScriptRoot\touch.conf").Path) {
+    $paths['built-in'] = @{ Executable = Install-Touch 'built-in' $Touch ''; Options = @() }
+  }
+  if ($Generated) {
+    $paths.generated = @{ Executable = Install-Touch 'generated' $Generated ''; Options = @() }
+  }
+  if ($Reference) {
+    $paths.reference = @{ Executable = Install-Touch 'reference' $Reference $Config; Options = @() }
+  }
+  # The first run publishes the cache file, every later one maps it.
+  Get-Rendering $paths.cached.Executable @() 'warm-up.c' | Out-Null
+
+  $mismatches = 0
+  foreach ($extension in $extensions) {
+    $file = "check$extension"
+    $expected = Get-Rendering $paths.compiled.Executable $paths.compiled.Options $file
+    foreach ($name in $paths.Keys) {
+      if ($name -eq 'compiled') { continue }
+      if ((Get-Rendering $paths[$name].Executable $paths[$name].Options $file) -ne $expected) {
+        Write-Host "$file : $name differs from compiled"
+        $mismatches++
+      }
+    }
+  }
+  Write-Host "$($extensions.Count) extensions, $($paths.Count) render paths, $mismatches mismatches"
+  if ($mismatches -gt 0) { exit 1 }
+}
+finally {
+  Remove-Item -Recurse -Force $work
+}
@@ -0,0 +1,634 @@
+// Render functions for the touch command.
+// Generated by `touch --emit-cpp touch.conf`, do not edit.
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace generated_templates {
+
+// Returns the value of a placeholder: kind 2 is the date, 3 the sequence number, 4 a UUID,
+// 5 a placeholder of a plugin and 6 the owners.
+typedef std::string (*value_function)(void *context, unsigned kind, const char *spec);
+typedef void (*render_function)(std::string &out, const std::string &filename, value_function value, void *context);
+
+// .ada
+inline void render_0(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(93 + filename.size());
+  out.append("-- FILE: ", 9);
+  out += filename;
+  out.append("\015\n-- Author: Generic Name\015\n-- Email: template_email@email.com\015\n-- DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .all
+inline void render_1(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(186 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n// FILE: ", 11);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .asm
+inline void render_2(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(683 + filename.size());
+  out.append("; FILE: ", 8);
+  out += filename;
+  out.append("\015\n; Author: Generic Name\015\n; Email: template_email@email.com\015\n; DATE: ", 69);
+  out += value(context, 2, "");
+  out.append("\015\n\015\nBITS 64\015\ndefault rel\015\nextern GetStdHandle\015\nextern WriteFile\015\nextern ExitProcess\015\nglobal _start\015\nsection .data\015\nmsg db \"Hello, World!\", 0\015\nmsg_len equ $-msg\015\nsection .bss\015\nStdHandle resq 1\015\nBytesWritten resq 1\015\nsection .text\015\n_start:\015\nsub rsp, 40 ; Reserve space for the parameters\015\n; Get standard output handle\015\nmov rcx, -11\015\ncall GetStdHandle\015\nmov qword [StdHandle], rax\015\n; Write message to standard output\015\nmov rcx, qword [StdHandle]\015\nlea rdx, [rel msg]\015\nmov r8d, msg_len\015\nlea r9, [rel BytesWritten]\015\nmov qword [rsp+32], 0\015\ncall WriteFile\015\n; Exit the process\015\nmov rcx, 0\015\ncall ExitProcess\015\n", 596);
+}
+
+// .bat
+inline void render_3(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(130 + filename.size());
+  out.append("REM FILE: ", 10);
+  out += filename;
+  out.append("\015\nREM Author: Generic Name\015\nREM Email: template_email@email.com\015\nREM DATE: ", 75);
+  out += value(context, 2, "");
+  out.append("\015\n\015\n@echo off\015\necho Hello, World!\015\n", 35);
+}
+
+// .c
+inline void render_4(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(266 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n\015\n#include <stdio.h>\015\n#include <stdlib.h>\015\n\015\n#define EXIT_SUCCESS 0\015\n#define EXIT_FAILURE 1\015\n\015\nint main(int argc, char *argv[]) {\015\nprintf(\"Hello, World!\\n\");\015\nreturn 0;\015\n}\015\n", 175);
+}
+
+// .clj
+inline void render_5(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(93 + filename.size());
+  out.append(";; FILE: ", 9);
+  out += filename;
+  out.append("\015\n;; Author: Generic Name\015\n;; Email: template_email@email.com\015\n;; DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .coffee
+inline void render_6(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(89 + filename.size());
+  out.append("# FILE: ", 8);
+  out += filename;
+  out.append("\015\n# Author: Generic Name\015\n# Email: template_email@email.com\015\n# DATE: ", 69);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .cpp
+inline void render_7(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(262 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n\015\n#include <iostream>\015\n\015\n#define EXIT_SUCCESS 0\015\n#define EXIT_FAILURE 1\015\n\015\nint main(int argc, char *argv[]) {\015\nstd::cout << \"Hello, World!\" << std::endl;\015\nreturn 0;\015\n}\015\n", 171);
+}
+
+// .cs
+inline void render_8(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(205 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n\015\nusing System;\015\nclass Program {\015\nstatic void Main(string[] args) {\015\nConsole.WriteLine(\"Hello, World!\");\015\n}\015\n}\015\n", 114);
+}
+
+// .dart
+inline void render_9(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(93 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .erl
+inline void render_10(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(89 + filename.size());
+  out.append("% FILE: ", 8);
+  out += filename;
+  out.append("\015\n% Author: Generic Name\015\n% Email: template_email@email.com\015\n% DATE: ", 69);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .ex
+inline void render_11(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(89 + filename.size());
+  out.append("# FILE: ", 8);
+  out += filename;
+  out.append("\015\n# Author: Generic Name\015\n# Email: template_email@email.com\015\n# DATE: ", 69);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .exs
+inline void render_12(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(89 + filename.size());
+  out.append("# FILE: ", 8);
+  out += filename;
+  out.append("\015\n# Author: Generic Name\015\n# Email: template_email@email.com\015\n# DATE: ", 69);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .f03
+inline void render_13(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(85 + filename.size());
+  out.append("!FILE: ", 7);
+  out += filename;
+  out.append("\015\n!Author: Generic Name\015\n!Email: template_email@email.com\015\n!DATE: ", 66);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .f90
+inline void render_14(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(85 + filename.size());
+  out.append("!FILE: ", 7);
+  out += filename;
+  out.append("\015\n!Author: Generic Name\015\n!Email: template_email@email.com\015\n!DATE: ", 66);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .f95
+inline void render_15(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(85 + filename.size());
+  out.append("!FILE: ", 7);
+  out += filename;
+  out.append("\015\n!Author: Generic Name\015\n!Email: template_email@email.com\015\n!DATE: ", 66);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .go
+inline void render_16(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(171 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n\015\npackage main\015\nimport \"fmt\"\015\nfunc main() {\015\nfmt.Println(\"Hello, World!\")\015\n}\015\n", 80);
+}
+
+// .groovy
+inline void render_17(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(93 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .h
+inline void render_18(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(93 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .hpp
+inline void render_19(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(93 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .hs
+inline void render_20(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(128 + filename.size());
+  out.append("-- FILE: ", 9);
+  out += filename;
+  out.append("\015\n-- Author: Generic Name\015\n-- Email: template_email@email.com\015\n-- DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n\015\nmain = putStrLn \"Hello, World!\"\015\n", 37);
+}
+
+// .java
+inline void render_21(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(202 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n\015\npublic class Main {\015\npublic static void main(String[] args) {\015\nSystem.out.println(\"Hello, World!\");\015\n}\015\n}\015\n", 111);
+}
+
+// .js
+inline void render_22(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(126 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n\015\nconsole.log(\"Hello, World!\");\015\n", 35);
+}
+
+// .kt
+inline void render_23(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(157 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n\015\nfun main(args: Array<String>) {\015\nprintln(\"Hello, World!\")\015\n}\015\n", 66);
+}
+
+// .lisp
+inline void render_24(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(93 + filename.size());
+  out.append(";; FILE: ", 9);
+  out += filename;
+  out.append("\015\n;; Author: Generic Name\015\n;; Email: template_email@email.com\015\n;; DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .lua
+inline void render_25(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(119 + filename.size());
+  out.append("-- FILE: ", 9);
+  out += filename;
+  out.append("\015\n-- Author: Generic Name\015\n-- Email: template_email@email.com\015\n-- DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n\015\nprint(\"Hello, World!\")\015\n", 28);
+}
+
+// .m
+inline void render_26(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(93 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .ml
+inline void render_27(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(102 + filename.size());
+  out.append("(*\015\n * FILE: ", 13);
+  out += filename;
+  out.append("\015\n * Author: Generic Name\015\n * Email: template_email@email.com\015\n * DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n *)\015\n", 7);
+}
+
+// .mm
+inline void render_28(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(93 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .nim
+inline void render_29(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(89 + filename.size());
+  out.append("# FILE: ", 8);
+  out += filename;
+  out.append("\015\n# Author: Generic Name\015\n# Email: template_email@email.com\015\n# DATE: ", 69);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .pas
+inline void render_30(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(93 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .php
+inline void render_31(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(129 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n\015\n<\077php\015\necho \"Hello, World!\";\015\n\077>\015\n", 38);
+}
+
+// .pl
+inline void render_32(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(134 + filename.size());
+  out.append("# FILE: ", 8);
+  out += filename;
+  out.append("\015\n# Author: Generic Name\015\n# Email: template_email@email.com\015\n# DATE: ", 69);
+  out += value(context, 2, "");
+  out.append("\015\n\015\n#!/usr/bin/perl\015\nprint \"Hello, World!\\n\";\015\n", 47);
+}
+
+// .pro
+inline void render_33(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(89 + filename.size());
+  out.append("% FILE: ", 8);
+  out += filename;
+  out.append("\015\n% Author: Generic Name\015\n% Email: template_email@email.com\015\n% DATE: ", 69);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .ps1
+inline void render_34(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(119 + filename.size());
+  out.append("# FILE: ", 8);
+  out += filename;
+  out.append("\015\n# Author: Generic Name\015\n# Email: template_email@email.com\015\n# DATE: ", 69);
+  out += value(context, 2, "");
+  out.append("\015\n\015\nWrite-Host \"Hello, World!\"\015\n", 32);
+}
+
+// .py
+inline void render_35(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(115 + filename.size());
+  out.append("# FILE: ", 8);
+  out += filename;
+  out.append("\015\n# Author: Generic Name\015\n# Email: template_email@email.com\015\n# DATE: ", 69);
+  out += value(context, 2, "");
+  out.append("\015\n\015\nprint(\"Hello, World!\")\015\n", 28);
+}
+
+// .r
+inline void render_36(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(115 + filename.size());
+  out.append("# FILE: ", 8);
+  out += filename;
+  out.append("\015\n# Author: Generic Name\015\n# Email: template_email@email.com\015\n# DATE: ", 69);
+  out += value(context, 2, "");
+  out.append("\015\n\015\ncat(\"Hello, World!\\n\")\015\n", 28);
+}
+
+// .rb
+inline void render_37(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(113 + filename.size());
+  out.append("# FILE: ", 8);
+  out += filename;
+  out.append("\015\n# Author: Generic Name\015\n# Email: template_email@email.com\015\n# DATE: ", 69);
+  out += value(context, 2, "");
+  out.append("\015\n\015\nputs \"Hello, World!\"\015\n", 26);
+}
+
+// .rkt
+inline void render_38(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(89 + filename.size());
+  out.append("; FILE: ", 8);
+  out += filename;
+  out.append("\015\n; Author: Generic Name\015\n; Email: template_email@email.com\015\n; DATE: ", 69);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .rs
+inline void render_39(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(139 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n\015\nfn main() {\015\nprintln!(\"Hello, World!\");\015\n}\015\n", 48);
+}
+
+// .s
+inline void render_40(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(89 + filename.size());
+  out.append("; FILE: ", 8);
+  out += filename;
+  out.append("\015\n; Author: Generic Name\015\n; Email: template_email@email.com\015\n; DATE: ", 69);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .scala
+inline void render_41(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(151 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n\015\nobject Main extends App {\015\nprintln(\"Hello, World!\")\015\n}\015\n", 60);
+}
+
+// .scm
+inline void render_42(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(93 + filename.size());
+  out.append(";; FILE: ", 9);
+  out += filename;
+  out.append("\015\n;; Author: Generic Name\015\n;; Email: template_email@email.com\015\n;; DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .sh
+inline void render_43(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(124 + filename.size());
+  out.append("# FILE: ", 8);
+  out += filename;
+  out.append("\015\n# Author: Generic Name\015\n# Email: template_email@email.com\015\n# DATE: ", 69);
+  out += value(context, 2, "");
+  out.append("\015\n\015\n#!/bin/sh\015\necho \"Hello, World!\"\015\n", 37);
+}
+
+// .sml
+inline void render_44(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(102 + filename.size());
+  out.append("(*\015\n * FILE: ", 13);
+  out += filename;
+  out.append("\015\n * Author: Generic Name\015\n * Email: template_email@email.com\015\n * DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n *)\015\n", 7);
+}
+
+// .sql
+inline void render_45(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(93 + filename.size());
+  out.append("-- FILE: ", 9);
+  out += filename;
+  out.append("\015\n-- Author: Generic Name\015\n-- Email: template_email@email.com\015\n-- DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .swift
+inline void render_46(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(138 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n\015\nimport Foundation\015\nprint(\"Hello, World!\")\015\n", 47);
+}
+
+// .ts
+inline void render_47(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(126 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n\015\nconsole.log(\"Hello, World!\");\015\n", 35);
+}
+
+// .vb
+inline void render_48(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(89 + filename.size());
+  out.append("' FILE: ", 8);
+  out += filename;
+  out.append("\015\n' Author: Generic Name\015\n' Email: template_email@email.com\015\n' DATE: ", 69);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .vba
+inline void render_49(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(89 + filename.size());
+  out.append("' FILE: ", 8);
+  out += filename;
+  out.append("\015\n' Author: Generic Name\015\n' Email: template_email@email.com\015\n' DATE: ", 69);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .vhd
+inline void render_50(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(93 + filename.size());
+  out.append("-- FILE: ", 9);
+  out += filename;
+  out.append("\015\n-- Author: Generic Name\015\n-- Email: template_email@email.com\015\n-- DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// .vhdl
+inline void render_51(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(93 + filename.size());
+  out.append("-- FILE: ", 9);
+  out += filename;
+  out.append("\015\n-- Author: Generic Name\015\n-- Email: template_email@email.com\015\n-- DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+// Any other extension
+inline void render_52(std::string &out, const std::string &filename, value_function value, void *context) {
+  out.reserve(93 + filename.size());
+  out.append("// FILE: ", 9);
+  out += filename;
+  out.append("\015\n// Author: Generic Name\015\n// Email: template_email@email.com\015\n// DATE: ", 72);
+  out += value(context, 2, "");
+  out.append("\015\n", 2);
+}
+
+struct plan_entry {
+  const char *extension;
+  size_t length;
+  render_function render;
+};
+
+// Sorted by extension for binary search.
+constexpr plan_entry plans[] = {
+  {".ada", 4, render_0},
+  {".all", 4, render_1},
+  {".asm", 4, render_2},
+  {".bat", 4, render_3},
+  {".c", 2, render_4},
+  {".clj", 4, render_5},
+  {".coffee", 7, render_6},
+  {".cpp", 4, render_7},
+  {".cs", 3, render_8},
+  {".dart", 5, render_9},
+  {".erl", 4, render_10},
+  {".ex", 3, render_11},
+  {".exs", 4, render_12},
+  {".f03", 4, render_13},
+  {".f90", 4, render_14},
+  {".f95", 4, render_15},
+  {".go", 3, render_16},
+  {".groovy", 7, render_17},
+  {".h", 2, render_18},
+  {".hpp", 4, render_19},
+  {".hs", 3, render_20},
+  {".java", 5, render_21},
+  {".js", 3, render_22},
+  {".kt", 3, render_23},
+  {".lisp", 5, render_24},
+  {".lua", 4, render_25},
+  {".m", 2, render_26},
+  {".ml", 3, render_27},
+  {".mm", 3, render_28},
+  {".nim", 4, render_29},
+  {".pas", 4, render_30},
+  {".php", 4, render_31},
+  {".pl", 3, render_32},
+  {".pro", 4, render_33},
+  {".ps1", 4, render_34},
+  {".py", 3, render_35},
+  {".r", 2, render_36},
+  {".rb", 3, render_37},
+  {".rkt", 4, render_38},
+  {".rs", 3, render_39},
+  {".s", 2, render_40},
+  {".scala", 6, render_41},
+  {".scm", 4, render_42},
+  {".sh", 3, render_43},
+  {".sml", 4, render_44},
+  {".sql", 4, render_45},
+  {".swift", 6, render_46},
+  {".ts", 3, render_47},
+  {".vb", 3, render_48},
+  {".vba", 4, render_49},
+  {".vhd", 4, render_50},
+  {".vhdl", 5, render_51},
+};
+
+constexpr size_t plan_count = 52;
+constexpr render_function default_plan = render_52;
+
+/**
+ * @brief Returns the render function of an extension.
+ */
+inline render_function find_plan(const std::string &extension) {
+  size_t low = 0;
+  size_t high = plan_count;
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    const plan_entry &entry = plans[middle];
+    size_t common = entry.length < extension.size() ? entry.length : extension.size();
+    int order = memcmp(entry.extension, extension.data(), common);
+    if (order == 0) order = (entry.length < extension.size()) ? -1 : (entry.length > extension.size());
+    if (order == 0) return entry.render;
+    if (order < 0) low = middle + 1;
+    else high = middle;
+  }
+  return default_plan;
+}
+
+} // namespace generated_templates
@@ -0,0 +1,239 @@
+// License texts for the <license:ID> placeholder of the touch command.
+// Generated by `touch --emit-licenses licenses`, do not edit.
+#pragma once
+
+#include <cstddef>
+
+namespace spdx_licenses {
+
+struct license_entry {
+  const char *id;
+  size_t offset;
+  size_t length;
+};
+
+// Offsets and lengths are in the decompressed texts.
+constexpr license_entry licenses[] = {
+  {"0BSD", 0, 633},
+  {"AGPL-3.0-or-later", 633, 658},
+  {"Apache-2.0", 1291, 546},
+  {"BSD-2-Clause", 1837, 1262},
+  {"BSD-3-Clause", 3099, 1454},
+  {"GPL-2.0-or-later", 4553, 705},
+  {"GPL-3.0-or-later", 5258, 637},
+  {"ISC", 5895, 723},
+  {"LGPL-3.0-or-later", 6618, 658},
+  {"MIT", 7276, 1049},
+  {"MPL-2.0", 8325, 193},
+  {"Unlicense", 8518, 1210},
+};
+
+constexpr size_t license_count = 12;
+constexpr size_t text_size = 9728;
+
+// Every text, concatenated and compressed in the LZ4 block format.
+constexpr unsigned char compressed[] = {
+  0xf4, 0x01, 0x43, 0x6f, 0x70, 0x79, 0x72, 0x69, 0x67, 0x68, 0x74, 0x20, 0x28, 0x63, 0x29, 0x20,
+  0x3c, 0x63, 0x0f, 0x00, 0xf0, 0x07, 0x3e, 0x0a, 0x0a, 0x50, 0x65, 0x72, 0x6d, 0x69, 0x73, 0x73,
+  0x69, 0x6f, 0x6e, 0x20, 0x74, 0x6f, 0x20, 0x75, 0x73, 0x65, 0x2c, 0x20, 0x1f, 0x00, 0xf1, 0x32,
+  0x2c, 0x20, 0x6d, 0x6f, 0x64, 0x69, 0x66, 0x79, 0x2c, 0x20, 0x61, 0x6e, 0x64, 0x2f, 0x6f, 0x72,
+  0x20, 0x64, 0x69, 0x73, 0x74, 0x72, 0x69, 0x62, 0x75, 0x74, 0x65, 0x20, 0x74, 0x68, 0x69, 0x73,
+  0x20, 0x73, 0x6f, 0x66, 0x74, 0x77, 0x61, 0x72, 0x65, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x61, 0x6e,
+  0x79, 0x20, 0x70, 0x75, 0x72, 0x70, 0x6f, 0x73, 0x65, 0x20, 0x77, 0x69, 0x74, 0x68, 0x20, 0x6f,
+  0x72, 0x08, 0x00, 0xf0, 0x32, 0x6f, 0x75, 0x74, 0x20, 0x66, 0x65, 0x65, 0x20, 0x69, 0x73, 0x20,
+  0x68, 0x65, 0x72, 0x65, 0x62, 0x79, 0x20, 0x67, 0x72, 0x61, 0x6e, 0x74, 0x65, 0x64, 0x2e, 0x0a,
+  0x0a, 0x54, 0x48, 0x45, 0x20, 0x53, 0x4f, 0x46, 0x54, 0x57, 0x41, 0x52, 0x45, 0x20, 0x49, 0x53,
+  0x20, 0x50, 0x52, 0x4f, 0x56, 0x49, 0x44, 0x45, 0x44, 0x20, 0x22, 0x41, 0x53, 0x20, 0x49, 0x53,
+  0x22, 0x20, 0x41, 0x4e, 0x44, 0x20, 0x25, 0x00, 0xf7, 0x24, 0x41, 0x55, 0x54, 0x48, 0x4f, 0x52,
+  0x20, 0x44, 0x49, 0x53, 0x43, 0x4c, 0x41, 0x49, 0x4d, 0x53, 0x20, 0x41, 0x4c, 0x4c, 0x20, 0x57,
+  0x41, 0x52, 0x52, 0x41, 0x4e, 0x54, 0x49, 0x45, 0x53, 0x20, 0x57, 0x49, 0x54, 0x48, 0x20, 0x52,
+  0x45, 0x47, 0x41, 0x52, 0x44, 0x20, 0x54, 0x4f, 0x20, 0x54, 0x48, 0x49, 0x53, 0x59, 0x00, 0x81,
+  0x4e, 0x43, 0x4c, 0x55, 0x44, 0x49, 0x4e, 0x47, 0x36, 0x00, 0x78, 0x49, 0x4d, 0x50, 0x4c, 0x49,
+  0x45, 0x44, 0x3e, 0x00, 0xf1, 0x03, 0x4f, 0x46, 0x20, 0x4d, 0x45, 0x52, 0x43, 0x48, 0x41, 0x4e,
+  0x54, 0x41, 0x42, 0x49, 0x4c, 0x49, 0x54, 0x59, 0x79, 0x00, 0xf0, 0x08, 0x46, 0x49, 0x54, 0x4e,
+  0x45, 0x53, 0x53, 0x2e, 0x20, 0x49, 0x4e, 0x20, 0x4e, 0x4f, 0x20, 0x45, 0x56, 0x45, 0x4e, 0x54,
+  0x20, 0x53, 0x48, 0x45, 0x00, 0x07, 0x94, 0x00, 0xf4, 0x16, 0x42, 0x45, 0x20, 0x4c, 0x49, 0x41,
+  0x42, 0x4c, 0x45, 0x20, 0x46, 0x4f, 0x52, 0x20, 0x41, 0x4e, 0x59, 0x20, 0x53, 0x50, 0x45, 0x43,
+  0x49, 0x41, 0x4c, 0x2c, 0x20, 0x44, 0x49, 0x52, 0x45, 0x43, 0x54, 0x2c, 0x20, 0x49, 0x4e, 0x0a,
+  0x00, 0xf0, 0x07, 0x4f, 0x52, 0x20, 0x43, 0x4f, 0x4e, 0x53, 0x45, 0x51, 0x55, 0x45, 0x4e, 0x54,
+  0x49, 0x41, 0x4c, 0x20, 0x44, 0x41, 0x4d, 0x41, 0x47, 0x83, 0x00, 0x02, 0x3b, 0x00, 0x04, 0x0f,
+  0x00, 0xf0, 0x02, 0x57, 0x48, 0x41, 0x54, 0x53, 0x4f, 0x45, 0x56, 0x45, 0x52, 0x20, 0x52, 0x45,
+  0x53, 0x55, 0x4c, 0x54, 0xbe, 0x00, 0x81, 0x46, 0x52, 0x4f, 0x4d, 0x20, 0x4c, 0x4f, 0x53, 0xb1,
+  0x00, 0x90, 0x55, 0x53, 0x45, 0x2c, 0x20, 0x44, 0x41, 0x54, 0x41, 0x3b, 0x00, 0xf0, 0x01, 0x50,
+  0x52, 0x4f, 0x46, 0x49, 0x54, 0x53, 0x2c, 0x20, 0x57, 0x48, 0x45, 0x54, 0x48, 0x45, 0x52, 0xb2,
+  0x00, 0x90, 0x41, 0x4e, 0x20, 0x41, 0x43, 0x54, 0x49, 0x4f, 0x4e, 0x2e, 0x00, 0x60, 0x43, 0x4f,
+  0x4e, 0x54, 0x52, 0x41, 0x82, 0x00, 0xa0, 0x4e, 0x45, 0x47, 0x4c, 0x49, 0x47, 0x45, 0x4e, 0x43,
+  0x45, 0x39, 0x00, 0x11, 0x4f, 0x2e, 0x00, 0x83, 0x54, 0x4f, 0x52, 0x54, 0x49, 0x4f, 0x55, 0x53,
+  0x31, 0x00, 0x60, 0x2c, 0x20, 0x41, 0x52, 0x49, 0x53, 0x72, 0x00, 0x30, 0x4f, 0x55, 0x54, 0x3e,
+  0x00, 0x11, 0x4f, 0x51, 0x00, 0x52, 0x43, 0x4f, 0x4e, 0x4e, 0x45, 0x52, 0x00, 0x01, 0x6f, 0x01,
+  0x00, 0x04, 0x01, 0x21, 0x55, 0x53, 0x47, 0x00, 0x81, 0x50, 0x45, 0x52, 0x46, 0x4f, 0x52, 0x4d,
+  0x41, 0x56, 0x00, 0x1a, 0x46, 0x7f, 0x01, 0x17, 0x2e, 0x79, 0x02, 0x1b, 0x43, 0x79, 0x02, 0x10,
+  0x54, 0x46, 0x02, 0x70, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x21, 0x02, 0x45, 0x66, 0x72,
+  0x65, 0x65, 0x56, 0x02, 0xc7, 0x3a, 0x20, 0x79, 0x6f, 0x75, 0x20, 0x63, 0x61, 0x6e, 0x20, 0x72,
+  0x65, 0x7a, 0x02, 0x24, 0x69, 0x74, 0x8f, 0x02, 0x02, 0x9e, 0x02, 0x00, 0x11, 0x00, 0xf1, 0x03,
+  0x75, 0x6e, 0x64, 0x65, 0x72, 0x20, 0x74, 0x68, 0x65, 0x20, 0x74, 0x65, 0x72, 0x6d, 0x73, 0x20,
+  0x6f, 0x66, 0x0d, 0x00, 0xf0, 0x17, 0x47, 0x4e, 0x55, 0x20, 0x41, 0x66, 0x66, 0x65, 0x72, 0x6f,
+  0x20, 0x47, 0x65, 0x6e, 0x65, 0x72, 0x61, 0x6c, 0x20, 0x50, 0x75, 0x62, 0x6c, 0x69, 0x63, 0x20,
+  0x4c, 0x69, 0x63, 0x65, 0x6e, 0x73, 0x65, 0x20, 0x61, 0x73, 0x20, 0x70, 0x12, 0x00, 0x71, 0x73,
+  0x68, 0x65, 0x64, 0x20, 0x62, 0x79, 0x36, 0x00, 0x10, 0x46, 0x85, 0x00, 0x14, 0x53, 0xdb, 0x02,
+  0xf1, 0x07, 0x46, 0x6f, 0x75, 0x6e, 0x64, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x2c, 0x20, 0x65, 0x69,
+  0x74, 0x68, 0x65, 0x72, 0x20, 0x76, 0x65, 0x72, 0x2c, 0x03, 0x14, 0x33, 0x68, 0x00, 0x03, 0x4e,
+  0x00, 0x10, 0x2c, 0xf3, 0x02, 0x30, 0x28, 0x61, 0x74, 0xb8, 0x00, 0x40, 0x72, 0x20, 0x6f, 0x70,
+  0x35, 0x00, 0x11, 0x29, 0x18, 0x03, 0x36, 0x6c, 0x61, 0x74, 0x38, 0x00, 0x00, 0xf8, 0x02, 0x0b,
+  0xf8, 0x00, 0x06, 0xdf, 0x00, 0x41, 0x64, 0x20, 0x69, 0x6e, 0x54, 0x00, 0x30, 0x68, 0x6f, 0x70,
+  0x66, 0x03, 0x20, 0x61, 0x74, 0xe0, 0x00, 0x70, 0x77, 0x69, 0x6c, 0x6c, 0x20, 0x62, 0x65, 0x9b,
+  0x03, 0x81, 0x66, 0x75, 0x6c, 0x2c, 0x20, 0x62, 0x75, 0x74, 0x84, 0x01, 0x00, 0xa0, 0x01, 0x00,
+  0x37, 0x02, 0x03, 0xcc, 0x02, 0x25, 0x59, 0x3b, 0x72, 0x03, 0x32, 0x65, 0x76, 0x65, 0x48, 0x00,
+  0xb0, 0x69, 0x6d, 0x70, 0x6c, 0x69, 0x65, 0x64, 0x20, 0x77, 0x61, 0x72, 0x77, 0x03, 0x10, 0x79,
+  0xb4, 0x00, 0x0c, 0xed, 0x02, 0x24, 0x6f, 0x72, 0xec, 0x02, 0x02, 0xc4, 0x02, 0xf0, 0x08, 0x20,
+  0x50, 0x41, 0x52, 0x54, 0x49, 0x43, 0x55, 0x4c, 0x41, 0x52, 0x20, 0x50, 0x55, 0x52, 0x50, 0x4f,
+  0x53, 0x45, 0x2e, 0x20, 0x53, 0x65, 0x90, 0x00, 0x0f, 0x55, 0x01, 0x11, 0x00, 0x0e, 0x04, 0xf1,
+  0x1a, 0x6d, 0x6f, 0x72, 0x65, 0x20, 0x64, 0x65, 0x74, 0x61, 0x69, 0x6c, 0x73, 0x2e, 0x0a, 0x0a,
+  0x59, 0x6f, 0x75, 0x20, 0x73, 0x68, 0x6f, 0x75, 0x6c, 0x64, 0x20, 0x68, 0x61, 0x76, 0x65, 0x20,
+  0x72, 0x65, 0x63, 0x65, 0x69, 0x76, 0x65, 0x64, 0x20, 0x61, 0x6a, 0x04, 0x0f, 0xb1, 0x01, 0x18,
+  0x42, 0x6c, 0x6f, 0x6e, 0x67, 0x60, 0x04, 0x01, 0x83, 0x04, 0x03, 0x45, 0x01, 0xf2, 0x15, 0x2e,
+  0x20, 0x49, 0x66, 0x20, 0x6e, 0x6f, 0x74, 0x2c, 0x20, 0x73, 0x65, 0x65, 0x20, 0x3c, 0x68, 0x74,
+  0x74, 0x70, 0x73, 0x3a, 0x2f, 0x2f, 0x77, 0x77, 0x77, 0x2e, 0x67, 0x6e, 0x75, 0x2e, 0x6f, 0x72,
+  0x67, 0x2f, 0x6c, 0x42, 0x00, 0x37, 0x73, 0x2f, 0x3e, 0x92, 0x02, 0x09, 0x8e, 0x02, 0x03, 0x64,
+  0x00, 0x17, 0x64, 0x4f, 0x02, 0x48, 0x41, 0x70, 0x61, 0x63, 0xe1, 0x01, 0x13, 0x56, 0xfb, 0x01,
+  0x50, 0x32, 0x2e, 0x30, 0x20, 0x28, 0x21, 0x00, 0x13, 0x22, 0x1b, 0x00, 0x31, 0x22, 0x29, 0x3b,
+  0xaf, 0x02, 0x30, 0x6d, 0x61, 0x79, 0x88, 0x00, 0x00, 0xaa, 0x01, 0x02, 0xa1, 0x00, 0xb0, 0x66,
+  0x69, 0x6c, 0x65, 0x20, 0x65, 0x78, 0x63, 0x65, 0x70, 0x74, 0xdb, 0x01, 0x20, 0x63, 0x6f, 0x90,
+  0x01, 0x33, 0x61, 0x6e, 0x63, 0x25, 0x05, 0x07, 0x3f, 0x02, 0x20, 0x2e, 0x20, 0x26, 0x01, 0x00,
+  0x41, 0x00, 0x6b, 0x6f, 0x62, 0x74, 0x61, 0x69, 0x6e, 0x1c, 0x01, 0x05, 0x02, 0x01, 0x70, 0x74,
+  0x0a, 0x0a, 0x20, 0x20, 0x20, 0x20, 0xe4, 0x00, 0x03, 0xe3, 0x00, 0x11, 0x61, 0xa6, 0x00, 0x0a,
+  0xe6, 0x00, 0xf2, 0x0b, 0x4c, 0x49, 0x43, 0x45, 0x4e, 0x53, 0x45, 0x2d, 0x32, 0x2e, 0x30, 0x0a,
+  0x0a, 0x55, 0x6e, 0x6c, 0x65, 0x73, 0x73, 0x20, 0x72, 0x65, 0x71, 0x75, 0x69, 0x72, 0xea, 0x02,
+  0xe0, 0x61, 0x70, 0x70, 0x6c, 0x69, 0x63, 0x61, 0x62, 0x6c, 0x65, 0x20, 0x6c, 0x61, 0x77, 0x03,
+  0x02, 0x60, 0x61, 0x67, 0x72, 0x65, 0x65, 0x64, 0x02, 0x06, 0xb6, 0x69, 0x6e, 0x20, 0x77, 0x72,
+  0x69, 0x74, 0x69, 0x6e, 0x67, 0x2c, 0xe4, 0x05, 0x08, 0xa4, 0x02, 0x06, 0x21, 0x01, 0x04, 0x96,
+  0x00, 0x0b, 0xc5, 0x02, 0x55, 0x6f, 0x6e, 0x20, 0x61, 0x6e, 0xc6, 0x05, 0x40, 0x42, 0x41, 0x53,
+  0x49, 0x9d, 0x04, 0x03, 0xb2, 0x02, 0x08, 0x7a, 0x05, 0x01, 0x10, 0x05, 0x20, 0x44, 0x49, 0x56,
+  0x04, 0x01, 0xd7, 0x04, 0x00, 0xce, 0x02, 0x45, 0x4b, 0x49, 0x4e, 0x44, 0x6d, 0x03, 0x40, 0x65,
+  0x78, 0x70, 0x72, 0xbc, 0x00, 0x24, 0x6f, 0x72, 0xcb, 0x02, 0x06, 0x8b, 0x02, 0x08, 0x71, 0x02,
+  0x00, 0x10, 0x00, 0xf5, 0x0e, 0x73, 0x70, 0x65, 0x63, 0x69, 0x66, 0x69, 0x63, 0x20, 0x6c, 0x61,
+  0x6e, 0x67, 0x75, 0x61, 0x67, 0x65, 0x20, 0x67, 0x6f, 0x76, 0x65, 0x72, 0x6e, 0x69, 0x6e, 0x67,
+  0x20, 0x70, 0xe4, 0x06, 0x10, 0x73, 0x40, 0x04, 0x61, 0x20, 0x6c, 0x69, 0x6d, 0x69, 0x74, 0xd8,
+  0x03, 0x1e, 0x73, 0xcf, 0x00, 0x08, 0xb4, 0x04, 0x0c, 0x2d, 0x07, 0x16, 0x52, 0x8d, 0x04, 0x00,
+  0x0a, 0x02, 0x00, 0x4c, 0x00, 0x00, 0xed, 0x01, 0x91, 0x69, 0x6e, 0x20, 0x73, 0x6f, 0x75, 0x72,
+  0x63, 0x65, 0x12, 0x00, 0x60, 0x62, 0x69, 0x6e, 0x61, 0x72, 0x79, 0x99, 0x00, 0x3d, 0x6d, 0x73,
+  0x2c, 0x0f, 0x07, 0x01, 0xb9, 0x04, 0x23, 0x69, 0x63, 0x56, 0x04, 0x00, 0x5d, 0x01, 0x01, 0x9e,
+  0x00, 0x10, 0x74, 0x3a, 0x01, 0x60, 0x70, 0x72, 0x6f, 0x76, 0x69, 0x64, 0x88, 0x01, 0x00, 0xfc,
+  0x03, 0x00, 0x94, 0x00, 0x60, 0x66, 0x6f, 0x6c, 0x6c, 0x6f, 0x77, 0xc4, 0x00, 0x52, 0x63, 0x6f,
+  0x6e, 0x64, 0x69, 0xb3, 0x00, 0x00, 0x35, 0x00, 0x9a, 0x6d, 0x65, 0x74, 0x3a, 0x0a, 0x0a, 0x31,
+  0x2e, 0x20, 0x93, 0x00, 0x01, 0xff, 0x04, 0x03, 0x8c, 0x00, 0xb0, 0x63, 0x6f, 0x64, 0x65, 0x20,
+  0x6d, 0x75, 0x73, 0x74, 0x20, 0x72, 0x8c, 0x03, 0x02, 0x13, 0x04, 0x40, 0x61, 0x62, 0x6f, 0x76,
+  0x1b, 0x00, 0x04, 0xe3, 0x00, 0x72, 0x6e, 0x6f, 0x74, 0x69, 0x63, 0x65, 0x2c, 0xb0, 0x02, 0x40,
+  0x6c, 0x69, 0x73, 0x74, 0x41, 0x00, 0x08, 0x6c, 0x00, 0x10, 0x6e, 0x8e, 0x00, 0x08, 0x89, 0x00,
+  0xee, 0x64, 0x69, 0x73, 0x63, 0x6c, 0x61, 0x69, 0x6d, 0x65, 0x72, 0x2e, 0x0a, 0x0a, 0x32, 0x81,
+  0x00, 0x28, 0x69, 0x6e, 0x02, 0x01, 0x04, 0x81, 0x00, 0x62, 0x70, 0x72, 0x6f, 0x64, 0x75, 0x63,
+  0xbb, 0x01, 0x0f, 0x84, 0x00, 0x39, 0x04, 0x33, 0x05, 0x72, 0x64, 0x6f, 0x63, 0x75, 0x6d, 0x65,
+  0x6e, 0xd6, 0x01, 0x04, 0x25, 0x06, 0x11, 0x6f, 0x46, 0x02, 0x10, 0x6d, 0x81, 0x05, 0x31, 0x69,
+  0x61, 0x6c, 0x31, 0x04, 0x02, 0x60, 0x01, 0x05, 0x7f, 0x03, 0x08, 0xbb, 0x00, 0x01, 0x94, 0x08,
+  0x09, 0x3c, 0x08, 0x07, 0x95, 0x08, 0x21, 0x42, 0x59, 0xf4, 0x06, 0xf1, 0x02, 0x43, 0x4f, 0x50,
+  0x59, 0x52, 0x49, 0x47, 0x48, 0x54, 0x20, 0x48, 0x4f, 0x4c, 0x44, 0x45, 0x52, 0x53, 0x2d, 0x08,
+  0x01, 0x62, 0x07, 0x79, 0x49, 0x42, 0x55, 0x54, 0x4f, 0x52, 0x53, 0xbf, 0x08, 0x00, 0xd2, 0x02,
+  0x40, 0x45, 0x58, 0x50, 0x52, 0x5e, 0x05, 0x00, 0x49, 0x07, 0x0d, 0x7f, 0x08, 0x00, 0x20, 0x08,
+  0x03, 0xa1, 0x08, 0xf0, 0x01, 0x2c, 0x20, 0x42, 0x55, 0x54, 0x20, 0x4e, 0x4f, 0x54, 0x20, 0x4c,
+  0x49, 0x4d, 0x49, 0x54, 0x45, 0xcd, 0x08, 0x11, 0x2c, 0x75, 0x00, 0x0f, 0xb6, 0x08, 0x1e, 0x0f,
+  0xca, 0x05, 0x06, 0x10, 0x20, 0xd7, 0x00, 0x04, 0x49, 0x09, 0x2f, 0x45, 0x44, 0xde, 0x08, 0x05,
+  0x0c, 0xe6, 0x00, 0x03, 0xab, 0x03, 0x06, 0xe4, 0x00, 0x0e, 0xf8, 0x08, 0x0e, 0xef, 0x08, 0x80,
+  0x49, 0x4e, 0x43, 0x49, 0x44, 0x45, 0x4e, 0x54, 0x0d, 0x09, 0x05, 0x16, 0x09, 0x9f, 0x45, 0x58,
+  0x45, 0x4d, 0x50, 0x4c, 0x41, 0x52, 0x59, 0x0f, 0x09, 0x08, 0x1f, 0x28, 0x13, 0x01, 0x0c, 0x80,
+  0x50, 0x52, 0x4f, 0x43, 0x55, 0x52, 0x45, 0x4d, 0xb4, 0x00, 0xf1, 0x03, 0x4f, 0x46, 0x20, 0x53,
+  0x55, 0x42, 0x53, 0x54, 0x49, 0x54, 0x55, 0x54, 0x45, 0x20, 0x47, 0x4f, 0x4f, 0x44, 0x69, 0x01,
+  0x9e, 0x53, 0x45, 0x52, 0x56, 0x49, 0x43, 0x45, 0x53, 0x3b, 0x33, 0x09, 0x01, 0x79, 0x00, 0x03,
+  0x34, 0x09, 0x10, 0x3b, 0x0c, 0x00, 0x41, 0x42, 0x55, 0x53, 0x49, 0x35, 0x01, 0x80, 0x49, 0x4e,
+  0x54, 0x45, 0x52, 0x52, 0x55, 0x50, 0x90, 0x04, 0x51, 0x29, 0x20, 0x48, 0x4f, 0x57, 0x83, 0x09,
+  0x50, 0x43, 0x41, 0x55, 0x53, 0x45, 0xca, 0x01, 0x30, 0x44, 0x20, 0x4f, 0x59, 0x09, 0x01, 0x08,
+  0x02, 0x30, 0x4f, 0x52, 0x59, 0x55, 0x00, 0x00, 0x04, 0x01, 0x01, 0x7d, 0x01, 0x09, 0x7d, 0x09,
+  0x06, 0x70, 0x09, 0x50, 0x53, 0x54, 0x52, 0x49, 0x43, 0xbd, 0x00, 0x05, 0x27, 0x00, 0x12, 0x4f,
+  0x71, 0x09, 0x07, 0xe4, 0x00, 0x0f, 0x95, 0x09, 0x01, 0x55, 0x57, 0x49, 0x53, 0x45, 0x29, 0x89,
+  0x09, 0x01, 0xd0, 0x09, 0x00, 0xe8, 0x07, 0x14, 0x59, 0x94, 0x09, 0x05, 0x7e, 0x09, 0x0b, 0x6f,
+  0x09, 0x11, 0x2c, 0xca, 0x01, 0x80, 0x20, 0x49, 0x46, 0x20, 0x41, 0x44, 0x56, 0x49, 0xb7, 0x00,
+  0x03, 0x2d, 0x00, 0x53, 0x50, 0x4f, 0x53, 0x53, 0x49, 0x28, 0x02, 0x01, 0x33, 0x01, 0x23, 0x43,
+  0x48, 0x6f, 0x01, 0x0f, 0xee, 0x04, 0xff, 0xea, 0x43, 0x33, 0x2e, 0x20, 0x4e, 0x6a, 0x07, 0x00,
+  0x1e, 0x00, 0x44, 0x6e, 0x61, 0x6d, 0x65, 0x71, 0x08, 0x06, 0xaf, 0x00, 0x30, 0x68, 0x6f, 0x6c,
+  0x21, 0x07, 0x13, 0x6e, 0x67, 0x07, 0x00, 0x25, 0x00, 0x01, 0x77, 0x01, 0x30, 0x69, 0x74, 0x73,
+  0xb6, 0x00, 0x02, 0x50, 0x00, 0x31, 0x6f, 0x72, 0x73, 0xbd, 0x08, 0x02, 0xa7, 0x0a, 0x01, 0x48,
+  0x08, 0x70, 0x65, 0x6e, 0x64, 0x6f, 0x72, 0x73, 0x65, 0x0d, 0x02, 0x70, 0x70, 0x72, 0x6f, 0x6d,
+  0x6f, 0x74, 0x65, 0x08, 0x00, 0x91, 0x64, 0x75, 0x63, 0x74, 0x73, 0x20, 0x64, 0x65, 0x72, 0x01,
+  0x0a, 0x4b, 0x66, 0x72, 0x6f, 0x6d, 0x4e, 0x0e, 0x04, 0x39, 0x02, 0x05, 0xcf, 0x07, 0x30, 0x70,
+  0x72, 0x69, 0x50, 0x02, 0x10, 0x72, 0x34, 0x02, 0x17, 0x6e, 0xca, 0x07, 0x0f, 0xae, 0x05, 0xff,
+  0xff, 0xf0, 0x0f, 0x50, 0x0f, 0x1a, 0x02, 0xa1, 0x0c, 0x0f, 0x50, 0x0f, 0x2d, 0x0f, 0x49, 0x0f,
+  0x30, 0x1c, 0x3b, 0x49, 0x0f, 0x1f, 0x32, 0x49, 0x0f, 0xe6, 0x0f, 0x42, 0x0f, 0x42, 0x0f, 0x3b,
+  0x0f, 0x1b, 0x33, 0x3b, 0x20, 0x69, 0x3b, 0x0f, 0x00, 0x61, 0x05, 0x10, 0x65, 0xb8, 0x05, 0x0f,
+  0x06, 0x11, 0x0b, 0xf0, 0x1c, 0x49, 0x6e, 0x63, 0x2e, 0x2c, 0x20, 0x35, 0x31, 0x20, 0x46, 0x72,
+  0x61, 0x6e, 0x6b, 0x6c, 0x69, 0x6e, 0x20, 0x53, 0x74, 0x72, 0x65, 0x65, 0x74, 0x2c, 0x20, 0x46,
+  0x69, 0x66, 0x74, 0x68, 0x20, 0x46, 0x6c, 0x6f, 0x6f, 0x72, 0x2c, 0x20, 0x42, 0x6f, 0x73, 0x74,
+  0x2f, 0x00, 0xff, 0x02, 0x4d, 0x41, 0x20, 0x30, 0x32, 0x31, 0x31, 0x30, 0x2d, 0x31, 0x33, 0x30,
+  0x31, 0x20, 0x55, 0x53, 0x41, 0x11, 0x12, 0x6c, 0x0f, 0x0a, 0x12, 0xff, 0x3c, 0x0f, 0xc1, 0x02,
+  0x70, 0x0f, 0xfc, 0x11, 0x25, 0x0f, 0x07, 0x17, 0x74, 0x1f, 0x2c, 0x05, 0x0b, 0x00, 0x0f, 0x30,
+  0x0a, 0x03, 0x03, 0x17, 0x0a, 0x00, 0xfa, 0x00, 0x06, 0xaa, 0x00, 0x04, 0x1b, 0x00, 0x41, 0x70,
+  0x70, 0x65, 0x61, 0x1c, 0x0a, 0x30, 0x61, 0x6c, 0x6c, 0x3a, 0x00, 0x20, 0x69, 0x65, 0x75, 0x01,
+  0x0f, 0x61, 0x17, 0xff, 0xff, 0x52, 0x6f, 0x4c, 0x65, 0x73, 0x73, 0x65, 0x72, 0x57, 0x05, 0xff,
+  0x3d, 0x0f, 0x55, 0x01, 0x0b, 0x0f, 0x5e, 0x05, 0x2b, 0x0f, 0xb1, 0x01, 0x0c, 0x0f, 0x65, 0x05,
+  0x57, 0x0f, 0x0b, 0x05, 0x00, 0x01, 0xa0, 0x02, 0x00, 0x0c, 0x0f, 0x40, 0x68, 0x61, 0x72, 0x67,
+  0x21, 0x0f, 0x12, 0x6f, 0x51, 0x05, 0x53, 0x65, 0x72, 0x73, 0x6f, 0x6e, 0x18, 0x17, 0x00, 0x0f,
+  0x0f, 0x08, 0xd6, 0x00, 0x08, 0x82, 0x05, 0x00, 0x22, 0x05, 0x70, 0x61, 0x73, 0x73, 0x6f, 0x63,
+  0x69, 0x61, 0xeb, 0x01, 0x0a, 0x24, 0x0f, 0x00, 0x8b, 0x17, 0x13, 0x73, 0xb7, 0x17, 0x04, 0x7f,
+  0x02, 0x21, 0x22, 0x29, 0x65, 0x00, 0x44, 0x64, 0x65, 0x61, 0x6c, 0x19, 0x02, 0x05, 0x9a, 0x02,
+  0x04, 0xeb, 0x01, 0x20, 0x72, 0x65, 0x3d, 0x02, 0x12, 0x63, 0xa3, 0x02, 0x60, 0x69, 0x6e, 0x63,
+  0x6c, 0x75, 0x64, 0x84, 0x00, 0x04, 0x1f, 0x00, 0x06, 0x4a, 0x16, 0x01, 0x3f, 0x00, 0x01, 0xe9,
+  0x00, 0x1f, 0x73, 0x42, 0x06, 0x04, 0x21, 0x6d, 0x65, 0xd7, 0x00, 0x03, 0x13, 0x03, 0x17, 0x2c,
+  0x98, 0x02, 0x31, 0x2c, 0x20, 0x73, 0x89, 0x01, 0x02, 0xe8, 0x02, 0x03, 0x81, 0x03, 0x25, 0x73,
+  0x65, 0xcd, 0x05, 0x04, 0xc2, 0x01, 0x04, 0x9e, 0x00, 0x01, 0x24, 0x00, 0x00, 0x66, 0x00, 0x02,
+  0x4d, 0x11, 0x03, 0x23, 0x01, 0x01, 0x78, 0x00, 0x21, 0x77, 0x68, 0x53, 0x0f, 0x07, 0xca, 0x00,
+  0x00, 0xfa, 0x03, 0x32, 0x75, 0x72, 0x6e, 0x86, 0x03, 0x00, 0xef, 0x00, 0x41, 0x6f, 0x20, 0x73,
+  0x6f, 0x72, 0x00, 0x44, 0x6a, 0x65, 0x63, 0x74, 0xf3, 0x09, 0x0f, 0x7b, 0x11, 0x01, 0x10, 0x3a,
+  0x4c, 0x03, 0x0f, 0x91, 0x06, 0x21, 0x20, 0x73, 0x68, 0x89, 0x06, 0x10, 0x62, 0x2b, 0x12, 0x00,
+  0x31, 0x01, 0x02, 0x78, 0x03, 0x06, 0x9c, 0x06, 0x00, 0x13, 0x03, 0xf5, 0x00, 0x73, 0x75, 0x62,
+  0x73, 0x74, 0x61, 0x6e, 0x74, 0x69, 0x61, 0x6c, 0x20, 0x70, 0x6f, 0x72, 0xce, 0x11, 0x08, 0xbb,
+  0x00, 0x0f, 0xc4, 0x06, 0x10, 0x0d, 0x59, 0x18, 0x01, 0x32, 0x0d, 0x06, 0x49, 0x18, 0x0e, 0xcf,
+  0x0f, 0x07, 0xc4, 0x0f, 0x0f, 0xb0, 0x0e, 0x00, 0x01, 0x78, 0x05, 0x0f, 0xbd, 0x06, 0x0a, 0x1f,
+  0x2c, 0xb7, 0x0f, 0x10, 0xd1, 0x4e, 0x44, 0x20, 0x4e, 0x4f, 0x4e, 0x49, 0x4e, 0x46, 0x52, 0x49,
+  0x4e, 0x47, 0xfb, 0x0e, 0x0f, 0xe7, 0x06, 0x0b, 0x03, 0x0c, 0x19, 0x0c, 0xad, 0x10, 0x0e, 0xfd,
+  0x06, 0x01, 0xa0, 0x07, 0x00, 0x9a, 0x06, 0x05, 0xd8, 0x06, 0x02, 0x64, 0x06, 0x0f, 0xdb, 0x0e,
+  0x03, 0x0f, 0xa5, 0x06, 0x04, 0x01, 0xd3, 0x0e, 0x08, 0xbd, 0x0e, 0x06, 0x93, 0x06, 0x00, 0x05,
+  0x07, 0x1f, 0x2c, 0x99, 0x06, 0x0f, 0x05, 0x92, 0x01, 0x00, 0x21, 0x0f, 0x06, 0xa9, 0x06, 0x02,
+  0x8c, 0x00, 0x70, 0x44, 0x45, 0x41, 0x4c, 0x49, 0x4e, 0x47, 0xa2, 0x0f, 0x09, 0x2d, 0x00, 0x11,
+  0x2e, 0x98, 0x05, 0x12, 0x53, 0xae, 0x13, 0x10, 0x43, 0xae, 0x13, 0x10, 0x46, 0x32, 0x13, 0x00,
+  0xc2, 0x03, 0x0a, 0x8b, 0x02, 0x09, 0x66, 0x06, 0x7b, 0x4d, 0x6f, 0x7a, 0x69, 0x6c, 0x6c, 0x61,
+  0xaa, 0x04, 0x40, 0x2c, 0x20, 0x76, 0x2e, 0x88, 0x1b, 0x01, 0x9a, 0x04, 0x0a, 0xe6, 0x04, 0x71,
+  0x4d, 0x50, 0x4c, 0x20, 0x77, 0x61, 0x73, 0x89, 0x1b, 0x08, 0xfa, 0x05, 0x06, 0xd6, 0x04, 0x00,
+  0x0b, 0x04, 0x11, 0x2c, 0x70, 0x1b, 0x00, 0xff, 0x06, 0x03, 0x70, 0x1b, 0x20, 0x6f, 0x6e, 0x5e,
+  0x1b, 0x01, 0x59, 0x1b, 0x00, 0xdc, 0x04, 0x12, 0x6d, 0x77, 0x00, 0x01, 0xdc, 0x04, 0x82, 0x4d,
+  0x50, 0x4c, 0x2f, 0x32, 0x2e, 0x30, 0x2f, 0xc1, 0x00, 0x04, 0x49, 0x07, 0x01, 0x0e, 0x15, 0x80,
+  0x6e, 0x65, 0x6e, 0x63, 0x75, 0x6d, 0x62, 0x65, 0x58, 0x1b, 0x05, 0x88, 0x04, 0x50, 0x72, 0x65,
+  0x6c, 0x65, 0x61, 0x06, 0x13, 0x23, 0x69, 0x6e, 0xd2, 0x00, 0x01, 0xf3, 0x03, 0x70, 0x63, 0x20,
+  0x64, 0x6f, 0x6d, 0x61, 0x69, 0xa2, 0x06, 0x30, 0x41, 0x6e, 0x79, 0x70, 0x00, 0x04, 0x4b, 0x00,
+  0x2b, 0x74, 0x6f, 0x2a, 0x04, 0x05, 0x23, 0x04, 0x03, 0x46, 0x04, 0x21, 0x6d, 0x70, 0xb3, 0x00,
+  0x00, 0x12, 0x04, 0x01, 0x07, 0x07, 0x0f, 0x85, 0x0a, 0x05, 0x05, 0x45, 0x07, 0x06, 0xa3, 0x15,
+  0x01, 0x17, 0x15, 0x01, 0x9b, 0x14, 0x00, 0xa0, 0x0a, 0x11, 0x73, 0x2d, 0x01, 0x01, 0x4f, 0x00,
+  0x04, 0xba, 0x15, 0x1c, 0x2c, 0xba, 0x0a, 0x01, 0x71, 0x00, 0x40, 0x6d, 0x65, 0x72, 0x63, 0x9b,
+  0x03, 0x10, 0x6f, 0xfa, 0x13, 0x26, 0x6e, 0x2d, 0x12, 0x00, 0x02, 0x7b, 0x04, 0x00, 0x44, 0x1c,
+  0x70, 0x6e, 0x79, 0x20, 0x6d, 0x65, 0x61, 0x6e, 0x81, 0x06, 0x92, 0x49, 0x6e, 0x20, 0x6a, 0x75,
+  0x72, 0x69, 0x73, 0x64, 0x29, 0x05, 0x12, 0x73, 0x5b, 0x07, 0x88, 0x72, 0x65, 0x63, 0x6f, 0x67,
+  0x6e, 0x69, 0x7a, 0x3c, 0x04, 0x40, 0x6c, 0x61, 0x77, 0x73, 0xfb, 0x14, 0x60, 0x65, 0x20, 0x61,
+  0x75, 0x74, 0x68, 0xb5, 0x14, 0x13, 0x72, 0x0a, 0x00, 0x03, 0xf2, 0x01, 0x08, 0xd1, 0x05, 0x30,
+  0x64, 0x65, 0x64, 0x3b, 0x16, 0x00, 0x6c, 0x01, 0x00, 0x70, 0x00, 0x14, 0x64, 0x43, 0x04, 0x03,
+  0x4c, 0x00, 0x40, 0x69, 0x6e, 0x74, 0x65, 0x9f, 0x05, 0x04, 0xbc, 0x05, 0x05, 0x38, 0x00, 0x0f,
+  0x76, 0x01, 0x02, 0x73, 0x20, 0x57, 0x65, 0x20, 0x6d, 0x61, 0x6b, 0x32, 0x01, 0x03, 0x5b, 0x00,
+  0x01, 0x1a, 0x06, 0x03, 0xda, 0x14, 0x61, 0x62, 0x65, 0x6e, 0x65, 0x66, 0x69, 0x8e, 0x15, 0x07,
+  0x3e, 0x00, 0x10, 0x61, 0xb4, 0x00, 0x23, 0x72, 0x67, 0xef, 0x04, 0x02, 0x59, 0x00, 0x50, 0x64,
+  0x65, 0x74, 0x72, 0x69, 0x5b, 0x06, 0x00, 0x2c, 0x00, 0x00, 0x8e, 0x08, 0x42, 0x68, 0x65, 0x69,
+  0x72, 0xb9, 0x15, 0xa1, 0x73, 0x75, 0x63, 0x63, 0x65, 0x73, 0x73, 0x6f, 0x72, 0x73, 0x71, 0x00,
+  0x00, 0xa3, 0x00, 0x04, 0x27, 0x05, 0x07, 0x73, 0x00, 0x20, 0x74, 0x6f, 0x1d, 0x05, 0x00, 0x7d,
+  0x02, 0x71, 0x76, 0x65, 0x72, 0x74, 0x20, 0x61, 0x63, 0x4a, 0x00, 0xa1, 0x72, 0x65, 0x6c, 0x69,
+  0x6e, 0x71, 0x75, 0x69, 0x73, 0x68, 0x5c, 0x00, 0x11, 0x69, 0xee, 0x14, 0x52, 0x70, 0x65, 0x74,
+  0x75, 0x69, 0x59, 0x08, 0x00, 0xfe, 0x00, 0x00, 0x10, 0x1d, 0x00, 0x1d, 0x00, 0x00, 0x6c, 0x00,
+  0x40, 0x66, 0x75, 0x74, 0x75, 0x6f, 0x02, 0x05, 0x74, 0x06, 0x0a, 0x3e, 0x01, 0x02, 0xb7, 0x09,
+  0x09, 0x7b, 0x01, 0x0f, 0x51, 0x05, 0xd8, 0x0f, 0x3c, 0x05, 0xbc, 0x34, 0x0a, 0x0a, 0x46, 0xf8,
+  0x09, 0x20, 0x69, 0x6e, 0xcf, 0x03, 0x03, 0x35, 0x0b, 0x11, 0x70, 0x6b, 0x04, 0x40, 0x20, 0x72,
+  0x65, 0x66, 0xa3, 0x0b, 0x16, 0x6f, 0x9d, 0x09, 0xe0, 0x75, 0x6e, 0x6c, 0x69, 0x63, 0x65, 0x6e,
+  0x73, 0x65, 0x2e, 0x6f, 0x72, 0x67, 0x3e,
+};
+
+constexpr size_t compressed_size = sizeof(compressed);
+
+} // namespace spdx_licenses
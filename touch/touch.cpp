@@ -16,16 +16,68 @@
 #include <fstream>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <queue>
+#include <deque>
+#if defined(__cpp_impl_coroutine)
+#include <coroutine> // For the asynchronous batch engine, requires /std:c++20
+#endif
+#include <cstdint>  // For uint32_t
+#include <cstdlib>  // For strtoul
 #include <cstring>  // For strcmp
 #include <ctime>    // For time_t
-#include <windows.h>// For GetModuleFileName
+#include <windows.h>// For GetModuleFileName, CreateFile and friends
+#include <winternl.h>// For NtCreateFile
+#include <psapi.h>   // For GetProcessMemoryInfo
+#ifndef TOUCH_NO_TRACEPOINTS
+#include <TraceLoggingProvider.h> // For the static tracepoints
+#endif
+#ifdef TOUCH_GENERATED_TEMPLATES
+#include "generated_templates.hpp" // Render functions from touch --emit-cpp, see README.md
+#else
+#include "default_templates.hpp"   // The shipped touch.conf, from touch --emit-cpp touch.conf
+#endif
+#include "spdx_licenses.hpp"         // License texts, from touch --emit-licenses licenses
+#include "touch_plugin.h"            // The C interface of plugin placeholders
 
 #define EXIT_SUCCESS 0
 #define EXIT_FAILURE 1
 
 #define VERSION "(Windows 11) 1.0.0"
 #define CONFIG_PATH "./touch.conf"
+#define CONFIG_CACHE_VERSION 9 // Format version of the compiled configuration cache
+#define AUTO_MAX_JOBS 64 // Upper bound for the number of workers with -j auto
+#define MAX_PENDING_ITEMS 4096 // Rendered files of a batch waiting for the I/O stage before rendering pauses
+#define MAX_RENDER_THREADS 4u // Upper bound for the number of render threads of a batch
+#define ASYNC_THREADS 4u // Number of threads of the asynchronous I/O executor
+#define ASYNC_DEFAULT_IN_FLIGHT 4096 // Default limit of files in flight with --async
+#define DEFAULT_JOURNAL "touch.journal" // Undo journal used by --transaction without a path
+#define JOURNAL_FLUSH_SIZE (16 * 1024) // Bytes of journal records gathered before they are written
+#define ROLLBACK_THREADS 16u // Upper bound for the number of threads restoring files in a rollback
+#define MANIFEST_MEMO_SIZE 4096 // Largest file content whose checksum is remembered for identical files
+#define MANIFEST_MEMO_ENTRIES 4096 // Maximum number of remembered checksums
+#define FILL_BLOCK_SIZE (1 << 20) // Size of the blocks the payload of --size is written in
+#define LICENSE_WIDTH 80 // Column license texts are reflowed to, including the comment prefix
+#define SEQUENCE_BLOCK 64 // Largest block of <seq> numbers a thread takes from the shared counter at once
+#define SEQUENCE_LOCK_TIMEOUT 10000 // Milliseconds to wait for a counter file another run has locked
+#define PLUGIN_VALUE_SIZE 256 // Buffer offered to a plugin for a value before asking for a larger one
+#define LATENCY_SUB_BUCKETS 16 // Buckets per power of two of the latency histograms, about 6% apart
+#define LATENCY_BUCKETS (61 * LATENCY_SUB_BUCKETS) // Enough buckets for any 64-bit number of nanoseconds
+#define PIPE_NAME "\\\\.\\pipe\\touch" // Pipe served by --serve-pipe without a name
+#define PIPE_LISTENERS 4 // Pipe instances waiting for clients at any time
+#define PIPE_BUFFER_SIZE (64 * 1024) // Bytes read from a pipe client at once
+#define PIPE_MAX_FRAME (64 * 1024) // Largest request frame a pipe client may send
+#define PIPE_MAX_IN_FLIGHT 1024 // Requests of a pipe client in progress before it is no longer read from
+#define PIPE_DRAIN_TIMEOUT 5000 // Milliseconds --serve-pipe waits for clients to read their last responses
 
 #undef DEBUG
 
@@ -42,6 +94,52 @@
   #define DEBUG_PRINT(...) ((void)0)
 #endif
 
+// Static tracepoints:
+//
+// TRACE_POINT(name, fields...): a TraceLogging event of the "WinDevTools.Touch" ETW
+// provider, for tracing a touch without a rebuild (see README.md). The provider is only
+// registered with --trace; otherwise, and while no trace session has it enabled, an
+// event costs a test of the provider's enabled flag and its fields are not evaluated.
+// Defining TOUCH_NO_TRACEPOINTS compiles them out altogether.
+#ifndef TOUCH_NO_TRACEPOINTS
+  // The GUID is the one ETW derives from the provider name, so tools can enable it by name.
+  TRACELOGGING_DEFINE_PROVIDER(trace_provider, "WinDevTools.Touch",
+    (0x3a846b33, 0x73f4, 0x5cbf, 0x1a, 0xd8, 0x2c, 0x50, 0xf9, 0x22, 0xec, 0xeb));
+  #define TRACE_REGISTER() SUCCEEDED(TraceLoggingRegister(trace_provider))
+  #define TRACE_UNREGISTER() TraceLoggingUnregister(trace_provider)
+  #define TRACE_POINT(name, ...) TraceLoggingWrite(trace_provider, name, __VA_ARGS__)
+#else
+  #define TRACE_REGISTER() false
+  #define TRACE_UNREGISTER() ((void)0)
+  #define TRACE_POINT(...) ((void)0)
+#endif
+
+/**
+ * @brief Registers the tracepoint provider for --trace and unregisters it when it goes
+ * out of scope, so ETW never holds a registration of an exited process.
+ */
+class trace_registration {
+public:
+  trace_registration() : registered(false) {}
+
+  ~trace_registration() {
+    if (registered) TRACE_UNREGISTER();
+  }
+
+  /**
+   * @brief Registers the provider, once.
+   */
+  void enable() {
+    if (!registered) registered = TRACE_REGISTER();
+  }
+
+  trace_registration(const trace_registration &) = delete;
+  trace_registration &operator=(const trace_registration &) = delete;
+
+private:
+  bool registered;
+};
+
 /**
  * @brief Global map storing variables set via the configuration file.
  */
@@ -64,77 +162,150 @@ struct option {
 std::unordered_map<std::string, std::vector<option>> type_options_map;
 
 /**
- * @brief Vector to store raw code lines from the configuration file.
- */
-std::vector<std::string> raw_code;
-
-/**
- * @brief Map of reserved option names.
- *
- * Currently not used in the implementation, but may be used for future validation.
- */
-const std::unordered_map<std::string, bool> reserved_names = {
-  {"<date>", true},
-  {"<file>", true},
-};
-
-/**
- * @brief Map of file extensions and their expected comment strings.
- */
-const std::unordered_map<std::string, std::string> comment_str_map = {
-    {".c",    "// "},
-    {".cpp",  "// "},
-    {".h",    "// "},
-    {".hpp",  "// "},
-    {".py",   "# "},
-    {".java", "// "},
-    {".js",   "// "},
-    {".ts",   "// "},
-    {".rb",   "# "},
-    {".go",   "// "},
-    {".rs",   "// "},
-    {".cs",   "// "},
-    {".php",  "// "},
-    {".swift","// "},
-    {".kt",   "// "},
-    {".scala","// "},
-    {".sh",   "# "},
-    {".pl",   "# "},
-    {".r",    "# "},
-    {".lua",  "-- "},
-    {".sql",  "-- "},
-    {".asm",  "; "},
-    {".s",    "; "},
-    {".vb",   "' "},
-    {".vba",  "' "},
-    {".m",    "// "},  // Objective-C (or ambiguous with MATLAB)
-    {".mm",   "// "},  // Objective-C++
-    {".erl",  "% "},
-    {".ex",   "# "},
-    {".exs",  "# "},
-    {".hs",   "-- "},
-    {".lisp", ";; "},
-    {".clj",  ";; "},
-    {".scm",  ";; "},
-    {".f90",  "!"},
-    {".f95",  "!"},
-    {".f03",  "!"},
-    {".ada",  "-- "},
-    {".pas",  "// "},
-    {".dart", "// "},
-    {".coffee","# "},
-    {".groovy","// "},
-    {".nim",  "# "},
-    {".rkt",  "; "},
-    {".vhd",  "-- "},
-    {".vhdl", "-- "},
-    {".pro",  "% "},
-    {".sml",  "(* "},  // Standard ML uses (* ... *) for block comments.
-    {".ml",   "(* "},  // OCaml uses the same syntax.
-    {".bat",  "REM "},
-    {".ps1",  "# "}
+ * @brief Map of raw code lines from the configuration file, grouped by type.
+ */
+std::unordered_map<std::string, std::vector<std::string>> type_raw_map;
+
+/**
+ * @brief Output settings of a type, set with "eol=" and "bom=" lines in its type block.
+ *
+ * Empty values are not set; the settings of ".all" apply to every type that doesn't set
+ * them itself.
+ */
+struct type_settings {
+  std::string eol;     /**< Line endings: "lf" or "crlf", which is the default. */
+  std::string bom;     /**< Byte order mark: "utf-8" or "none". */
+  std::string comment; /**< Header comments: "line" or "block". */
+};
+
+/**
+ * @brief Map of output settings from the configuration file, grouped by type.
+ */
+std::unordered_map<std::string, type_settings> type_settings_map;
+
+/**
+ * @brief Names of the built-in placeholders, which plugins can't provide.
+ */
+constexpr const char *reserved_names[] = {"date", "file", "seq", "uuid", "license", "owner"};
+
+/**
+ * @brief How a language writes comments.
+ *
+ * Header lines are written as line comments where the language has them; a block comment
+ * is used if the type asks for one with "comment=block" or if there is nothing else.
+ */
+struct comment_style {
+  const char *line;        /**< Prefix of a line comment, nullptr if the language has none. */
+  const char *block_open;  /**< Line opening a block comment, nullptr if the language has none. */
+  const char *block_line;  /**< Prefix of the lines inside a block comment. */
+  const char *block_close; /**< Line closing a block comment. */
+};
+
+/**
+ * @brief The comment style of files without a style of their own.
+ */
+constexpr comment_style default_comment_style = {"// ", "/*", " * ", " */"};
+
+/**
+ * @brief A file extension and its comment style.
+ */
+struct comment_style_entry {
+  const char *extension;
+  comment_style style;
+};
+
+/**
+ * @brief File extensions and their comment styles, sorted by extension for binary search.
+ *
+ * A constant table rather than a map, so nothing is built at startup.
+ */
+constexpr comment_style_entry comment_styles[] = {
+    {".ada",  {"-- ", nullptr, nullptr, nullptr}},
+    {".asm",  {"; ", nullptr, nullptr, nullptr}},
+    {".bat",  {"REM ", nullptr, nullptr, nullptr}},
+    {".c",    {"// ", "/*", " * ", " */"}},
+    {".clj",  {";; ", nullptr, nullptr, nullptr}},
+    {".coffee", {"# ", "###", "", "###"}},
+    {".cpp",  {"// ", "/*", " * ", " */"}},
+    {".cs",   {"// ", "/*", " * ", " */"}},
+    {".dart", {"// ", "/*", " * ", " */"}},
+    {".erl",  {"% ", nullptr, nullptr, nullptr}},
+    {".ex",   {"# ", nullptr, nullptr, nullptr}},
+    {".exs",  {"# ", nullptr, nullptr, nullptr}},
+    {".f03",  {"!", nullptr, nullptr, nullptr}},
+    {".f90",  {"!", nullptr, nullptr, nullptr}},
+    {".f95",  {"!", nullptr, nullptr, nullptr}},
+    {".go",   {"// ", "/*", " * ", " */"}},
+    {".groovy", {"// ", "/*", " * ", " */"}},
+    {".h",    {"// ", "/*", " * ", " */"}},
+    {".hpp",  {"// ", "/*", " * ", " */"}},
+    {".hs",   {"-- ", "{-", "  ", "-}"}},
+    {".java", {"// ", "/*", " * ", " */"}},
+    {".js",   {"// ", "/*", " * ", " */"}},
+    {".kt",   {"// ", "/*", " * ", " */"}},
+    {".lisp", {";; ", "#|", "  ", "|#"}},
+    {".lua",  {"-- ", "--[[", "  ", "]]"}},
+    {".m",    {"// ", "/*", " * ", " */"}},  // Objective-C (or ambiguous with MATLAB)
+    {".ml",   {nullptr, "(*", " * ", " *)"}},  // OCaml only has (* ... *) comments, like Standard ML.
+    {".mm",   {"// ", "/*", " * ", " */"}},  // Objective-C++
+    {".nim",  {"# ", "#[", "  ", "]#"}},
+    {".pas",  {"// ", "{", "  ", "}"}},
+    {".php",  {"// ", "/*", " * ", " */"}},
+    {".pl",   {"# ", nullptr, nullptr, nullptr}},
+    {".pro",  {"% ", "/*", " * ", " */"}},
+    {".ps1",  {"# ", "<#", "  ", "#>"}},
+    {".py",   {"# ", nullptr, nullptr, nullptr}},
+    {".r",    {"# ", nullptr, nullptr, nullptr}},
+    {".rb",   {"# ", "=begin", "", "=end"}},
+    {".rkt",  {"; ", "#|", "  ", "|#"}},
+    {".rs",   {"// ", "/*", " * ", " */"}},
+    {".s",    {"; ", nullptr, nullptr, nullptr}},
+    {".scala", {"// ", "/*", " * ", " */"}},
+    {".scm",  {";; ", "#|", "  ", "|#"}},
+    {".sh",   {"# ", nullptr, nullptr, nullptr}},
+    {".sml",  {nullptr, "(*", " * ", " *)"}},  // Standard ML only has (* ... *) comments.
+    {".sql",  {"-- ", "/*", " * ", " */"}},
+    {".swift", {"// ", "/*", " * ", " */"}},
+    {".ts",   {"// ", "/*", " * ", " */"}},
+    {".vb",   {"' ", nullptr, nullptr, nullptr}},
+    {".vba",  {"' ", nullptr, nullptr, nullptr}},
+    {".vhd",  {"-- ", nullptr, nullptr, nullptr}},
+    {".vhdl", {"-- ", nullptr, nullptr, nullptr}}
 };
 
+/**
+ * @brief True if comment_styles is sorted, which find_comment_style() relies on.
+ */
+constexpr bool comment_styles_sorted() {
+  for (size_t i = 1; i < sizeof(comment_styles) / sizeof(comment_styles[0]); i++) {
+    const char *a = comment_styles[i - 1].extension;
+    const char *b = comment_styles[i].extension;
+    while (*a != '\0' && *a == *b) {
+      a++;
+      b++;
+    }
+    if ((unsigned char)*a >= (unsigned char)*b) return false;
+  }
+  return true;
+}
+static_assert(comment_styles_sorted(), "comment_styles must be sorted by extension");
+
+/**
+ * @brief Returns the comment style of an extension, or nullptr if it has none.
+ */
+const comment_style *find_comment_style(const std::string &file_extension) {
+  size_t low = 0;
+  size_t high = sizeof(comment_styles) / sizeof(comment_styles[0]);
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    int order = strcmp(comment_styles[middle].extension, file_extension.c_str());
+    if (order == 0) return &comment_styles[middle].style;
+    if (order < 0) low = middle + 1;
+    else high = middle;
+  }
+  return nullptr;
+}
+
 /**
  * @brief Retrieves the directory path of the current executable.
  *
@@ -144,11 +315,15 @@ const std::unordered_map<std::string, std::string> comment_str_map = {
  * @return A string containing the directory path of the executable.
  */
 std::string get_exe_path() {
-    char buffer[MAX_PATH];
-    GetModuleFileName(NULL, buffer, MAX_PATH);
-    std::string path(buffer);
-    std::string::size_type pos = path.find_last_of("\\/");
-    return (pos != std::string::npos) ? path.substr(0, pos) : "";
+    // The executable doesn't move while it runs, so the path is only looked up once.
+    static const std::string directory = []() {
+      char buffer[MAX_PATH];
+      GetModuleFileName(NULL, buffer, MAX_PATH);
+      std::string path(buffer);
+      std::string::size_type pos = path.find_last_of("\\/");
+      return (pos != std::string::npos) ? path.substr(0, pos) : "";
+    }();
+    return directory;
 }
 
 /**
@@ -179,307 +354,7280 @@ std::string get_current_date() {
 }
 
 /**
- * @brief Converts an option identifier to its final output form.
+ * @brief Sleeps for the given number of microseconds.
  *
- * Special option identifiers (such as "<date>" and "<file>") are replaced with their
- * corresponding values. If an option exists in the variable map, that value is returned.
- * Otherwise, the original option is returned.
+ * Sleep() only has millisecond (and usually 15.6 ms) resolution, which is far too coarse
+ * for simulating storage latency, so a high resolution waitable timer is used when the
+ * system supports it.
  *
- * @param option The option identifier to convert.
- * @param filename The filename used for substituting the "<file>" option.
- * @return A string containing the converted option.
+ * @param microseconds The time to sleep.
  */
-std::string convert_option(const std::string &option, const std::string &filename) {
-  if (option == "<date>") {
-    return "DATE: " + get_current_date();
-  }
-  else if (option == "<file>") {
-    return "FILE: " + filename;
+void sleep_microseconds(unsigned long long microseconds) {
+  if (microseconds == 0) return;
+  static thread_local HANDLE timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+  if (timer == NULL) {
+    Sleep((DWORD)((microseconds + 999) / 1000));
+    return;
   }
-  else {
-    if (variable_map.find(option) != variable_map.end()) {
-      return variable_map[option];
-    }
-    else {
-      return option;
+  LARGE_INTEGER due;
+  due.QuadPart = -(LONGLONG)(microseconds * 10); // Relative time in 100 ns units.
+  SetWaitableTimer(timer, &due, 0, NULL, NULL, FALSE);
+  WaitForSingleObject(timer, INFINITE);
+}
+
+/**
+ * @brief Writes a whole buffer to a file or pipe handle, in as many WriteFile calls as needed.
+ * @return True if the whole buffer was written.
+ */
+bool write_all(HANDLE out, const char *data, size_t size) {
+  while (size > 0) {
+    DWORD chunk = (size > 0x40000000) ? 0x40000000 : (DWORD)size;
+    DWORD written = 0;
+    if (!WriteFile(out, data, chunk, &written, NULL) || written == 0) {
+      return false;
     }
+    data += written;
+    size -= written;
   }
+  return true;
 }
 
 /**
- * @brief Parses the configuration file.
- *
- * This function reads the configuration file line by line and processes various commands:
- * - "SET" commands to define variables.
- * - "<type ...>" commands to declare option types.
- * - "<prepend>", "<append>", and "<raw>" markers to set context for options.
- *
- * Options are stored in the global maps for later processing.
- *
- * @param filename The path to the configuration file.
- * @param file_extension The file extension of the target file, used to determine which options are relevant.
+ * @brief A block of FILL_BLOCK_SIZE zero bytes that stays valid for the whole run.
  */
-void parse_config_file(const char *filename, const std::string &file_extension) {
-  std::ifstream file(filename);
-  if (!file.is_open()) {
-    ERROR_PRINT("Error: Could not open configuration file %s\n", filename);
-    return;
-  }
+const char *zero_fill_block() {
+  static const std::vector<char> block(FILL_BLOCK_SIZE, 0);
+  return block.data();
+}
 
-  std::string line;
-  std::string current_type = "";
-  bool is_prepend = false;
-  bool is_raw = false;
-  while (std::getline(file, line)) {
-    // Trim leading and trailing whitespace.
-    line.erase(0, line.find_first_not_of(" \t"));
-    line.erase(line.find_last_not_of(" \t") + 1);
+/**
+ * @brief Converts a Win32 FILETIME to a time_t.
+ */
+time_t filetime_to_time_t(const FILETIME &filetime) {
+  unsigned long long ticks = ((unsigned long long)filetime.dwHighDateTime << 32) | filetime.dwLowDateTime;
+  return (time_t)(ticks / 10000000ULL - 11644473600ULL);
+}
 
-    // Skip empty lines.
-    if (line.empty()) continue;
+/**
+ * @brief Converts a time_t to a Win32 FILETIME.
+ */
+FILETIME time_t_to_filetime(time_t time) {
+  unsigned long long ticks = ((unsigned long long)time + 11644473600ULL) * 10000000ULL;
+  FILETIME filetime;
+  filetime.dwLowDateTime = (DWORD)ticks;
+  filetime.dwHighDateTime = (DWORD)(ticks >> 32);
+  return filetime;
+}
 
-    if (line.find("SET ") == 0) {
-      // Process SET commands.
-      size_t pos = 4;
-      size_t equal_pos = line.find('=', pos);
-      if (equal_pos == std::string::npos) {
-        ERROR_PRINT("Error: Invalid SET command syntax: %s\n", line.c_str());
-        continue;
-      }
-      std::string var_name = line.substr(pos, equal_pos - pos);
-      var_name.erase(0, var_name.find_first_not_of(" \t"));
-      var_name.erase(var_name.find_last_not_of(" \t") + 1);
-      
-      std::string var_value = line.substr(equal_pos + 1);
-      var_value.erase(0, var_value.find_first_not_of(" \t"));
-      var_value.erase(var_value.find_last_not_of(" \t") + 1);
+/**
+ * @brief Phases of a run measured by --timings=hw.
+ */
+enum timing_phase {
+  PHASE_CONFIG_LOAD = 0, /**< Reading the configuration: mapping the cache, or parsing it on a miss. */
+  PHASE_COMPILE = 1,     /**< Compiling the parsed configuration into render plans. */
+  PHASE_RENDER = 2,      /**< Rendering the messages of files. */
+  PHASE_WRITE = 3,       /**< Creating and writing files, except asynchronous ones. */
+  PHASE_COUNT = 4
+};
 
-      // Remove surrounding quotes if present.
-      if (!var_value.empty() && var_value.front() == '"' && var_value.back() == '"') {
-        var_value = var_value.substr(1, var_value.size() - 2);
-      }
+/**
+ * @brief True if the phases of the run are measured, set by --timings=hw.
+ */
+bool hw_timings = false;
 
-      // Store variables with angle brackets for easy substitution.
-      variable_map["<" + var_name + ">"] = var_value;
-      continue;
-    }
-    else if (line.find("<type ") == 0) {
-      // Extract type name.
-      current_type = line.substr(6, line.size() - 7);
-      is_prepend = false;
-      is_raw = false;
-      if (type_options_map.find(current_type) == type_options_map.end()) {
-        type_options_map[current_type] = std::vector<option>();
-      }
-      DEBUG_PRINT("Found type: %s\n", current_type.c_str());
-      continue;
-    }
-    else if (line.find("<prepend>") == 0) {
-      is_prepend = true;
-      DEBUG_PRINT("Found prepend\n");
-      continue;
-    }
-    else if (line.find("<append>") == 0) {
-      is_prepend = false;
-      DEBUG_PRINT("Found append\n");
-      continue;
-    }
-    else if (line.find("<raw>") == 0) {
-      is_raw = true;
-      DEBUG_PRINT("Found raw\n");
-      continue;
-    }
-    else {
-      // Treat any other line as an option if inside a type block.
-      if (current_type.empty()) {
-        ERROR_PRINT("Error: Option %s is not inside a type block\n", line.c_str());
-      } 
-      else if (is_raw && current_type == file_extension) {
-        DEBUG_PRINT("Found raw option: %s\n", line.c_str());
-        raw_code.push_back(line);
-      }
-      else {
-        DEBUG_PRINT("Found option: %s\n", line.c_str());
-        type_options_map[current_type].push_back({line, is_prepend});
-      }
-    }
-  }
-}
+/**
+ * @brief The counters of one phase, summed over every thread that ran it.
+ */
+struct phase_totals {
+  std::atomic<unsigned long long> calls{0};
+  std::atomic<unsigned long long> wall_ticks{0};  /**< QueryPerformanceCounter ticks. */
+  std::atomic<unsigned long long> cycles{0};
+  std::atomic<unsigned long long> page_faults{0};
+};
 
 /**
- * @brief Prints help information to the console.
- *
- * This function outputs usage instructions, available command-line options,
- * and repository information for the touch command.
+ * @brief The counters of every phase of this run.
  */
-void print_help() {
-  INFO_PRINT("Usage: touch FILE...\n");
-  INFO_PRINT("Customize the touch command using the configuration file %s\n", get_config_path().c_str());
-  INFO_PRINT("\nOptions:\n");
-  INFO_PRINT("  --version  Display version information\n");
-  INFO_PRINT("  --help     Display this help message\n\n");
-  INFO_PRINT("touch.exe is a private non-commercial project bundled with win_dev_tools by Gustav Pettersson Björklund.\n");
-  INFO_PRINT("This program comes with NO WARRANTY. If you are missing some functionality feel free to contribute :D \n");
-  INFO_PRINT("For feature requests or issues, please create an issue on the GitHub repository:\n");
-  INFO_PRINT("https://github.com/GustavPetterssonBjorklund/win_dev_tools\n");
-}
+phase_totals phase_stats[PHASE_COUNT];
 
 /**
- * @brief Prompts the user for confirmation before performing an action.
- *
- * This function displays a prompt asking whether the user wants to perform
- * a specific action. The user must enter a confirmation phrase to proceed.
- *
- * @param action A description of the action that requires confirmation.
- * @param confirmation_type_phrase The phrase the user must type to confirm.
- * @return True if the user confirms the action, false otherwise.
+ * @brief False once reading a counter failed, e.g. because the system doesn't allow it.
  */
-bool confirm_action(const char* action, const char* confirmation_type_phrase) {
-  INFO_PRINT("Do you want to %s? [y/N] ", action);
-  char response;
-  scanf_s(" %c", &response, 1);
-  if (response == 'y' || response == 'Y') {
-    INFO_PRINT("Please type \"%s\" to confirm that you want to %s: ", confirmation_type_phrase, action);
-    char confirmation[100];
-    scanf_s("%s", confirmation, (unsigned)sizeof(confirmation));
-    return (strcmp(confirmation, confirmation_type_phrase) == 0);
+std::atomic<bool> cycles_available(true);
+std::atomic<bool> page_faults_available(true);
+
+/**
+ * @brief Returns the number of page faults of this process so far.
+ */
+unsigned long long process_page_faults() {
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+    page_faults_available.store(false, std::memory_order_relaxed);
+    return 0;
   }
-  return false;
+  return counters.PageFaultCount;
 }
 
 /**
- * @brief The main entry point for the touch command.
+ * @brief Adds the counters of a scope to a phase, if --timings=hw is given.
  *
- * This function processes command-line arguments, checks for file existence,
- * parses the configuration file, gathers options and raw code, builds the final
- * file message, and writes the message to the target file.
- *
- * @param argc The number of command-line arguments.
- * @param argv Array of command-line argument strings.
- * @return EXIT_SUCCESS if the program completes successfully, otherwise EXIT_FAILURE.
+ * Linux reads such counters with perf_event_open. Windows only lets a process read the
+ * cycles of its threads (QueryThreadCycleTime) and its own page faults; instructions,
+ * cache misses and branch misses need a kernel trace session and are reported as not
+ * available. Cycles are counted per thread and add up over threads running a phase in
+ * parallel, page faults are counted for the whole process, so phases running at the
+ * same time also count each other's. Without --timings=hw a timer costs one branch.
  */
-int main(int argc, char *argv[]) {
-  std::string file_extension;
-  std::string filename;
-
-  if (argc > 1) {
-    if (strcmp(argv[1], "--version") == 0) {
-      INFO_PRINT("touch %s\n", VERSION);
-      return EXIT_SUCCESS;
-    }
-    else if (strcmp(argv[1], "--help") == 0) {
-      print_help();
-      return EXIT_SUCCESS;
-    }
-    else {
-      FILE *file = nullptr;
-      filename = argv[1];
-      // Check if file exists.
-      if (fopen_s(&file, argv[1], "r") == 0 && file != nullptr) {
-        ERROR_PRINT("Error: File %s already exists\n", argv[1]);
-        fclose(file);
-        if (!confirm_action("overwrite the file", "overwrite")) {
-          INFO_PRINT("Aborting file creation...\n");
-          return EXIT_FAILURE;
-        }
-      }
-      DEBUG_PRINT("Creating file: %s\n", argv[1]);
-      if (fopen_s(&file, argv[1], "w") != 0 || file == nullptr) {
-        ERROR_PRINT("Error: Could not create file %s\n", argv[1]);
-        return EXIT_FAILURE;
-      }
-      else {
-        size_t dot_pos = filename.find_last_of(".");
-        file_extension = (dot_pos != std::string::npos) ? filename.substr(dot_pos) : "";
-        DEBUG_PRINT("Created file of type %s: %s\n", file_extension.c_str(), argv[1]);
-      }
-      fclose(file);
-    }
-  }
-  else {
-    ERROR_PRINT("Error: No file name provided\n");
-    print_help();
-    return EXIT_FAILURE;
-  }
-
-  // Parse configuration file from the executable's directory.
-  std::string config_path = get_config_path();
-  parse_config_file(config_path.c_str(), file_extension);
-
-  // Gather options based on file extension.
-  std::vector<std::string> prepend_options;
-  std::vector<std::string> append_options;
-  std::vector<std::string> default_options;
-  if (type_options_map.find(file_extension) != type_options_map.end()) {
-    for (auto const &opt : type_options_map[file_extension]) {
-      if (opt.is_prepend) {
-        DEBUG_PRINT("Prepending option: %s\n", opt.identifier.c_str());
-        prepend_options.push_back(opt.identifier);
-      }
-      else {
-        DEBUG_PRINT("Appending option: %s\n", opt.identifier.c_str());
-        append_options.push_back(opt.identifier);
-      }
+class phase_timer {
+public:
+  explicit phase_timer(timing_phase phase) : phase(phase), active(hw_timings) {
+    if (!active) return;
+    start_faults = process_page_faults();
+    if (!QueryThreadCycleTime(GetCurrentThread(), &start_cycles)) {
+      cycles_available.store(false, std::memory_order_relaxed);
     }
-  }
-  else {
-    DEBUG_PRINT("Error: No configuration found for file type %s\n", file_extension.c_str());
+    QueryPerformanceCounter(&start_wall);
   }
 
-  if (type_options_map.find(".all") != type_options_map.end()) {
-    for (auto const &opt : type_options_map[".all"]) {
-      DEBUG_PRINT("Adding default option: %s\n", opt.identifier.c_str());
-      default_options.push_back(opt.identifier);
-    }
+  ~phase_timer() {
+    if (!active) return;
+    LARGE_INTEGER end_wall;
+    QueryPerformanceCounter(&end_wall);
+    ULONG64 end_cycles = start_cycles;
+    QueryThreadCycleTime(GetCurrentThread(), &end_cycles);
+    unsigned long long end_faults = process_page_faults();
+    phase_totals &totals = phase_stats[phase];
+    totals.calls.fetch_add(1, std::memory_order_relaxed);
+    totals.wall_ticks.fetch_add(end_wall.QuadPart - start_wall.QuadPart, std::memory_order_relaxed);
+    totals.cycles.fetch_add(end_cycles - start_cycles, std::memory_order_relaxed);
+    totals.page_faults.fetch_add(end_faults - start_faults, std::memory_order_relaxed);
   }
 
-  // Merge options in the correct order.
-  std::vector<std::string> all_options;
-  all_options.insert(all_options.end(), prepend_options.begin(), prepend_options.end());
-  all_options.insert(all_options.end(), default_options.begin(), default_options.end());
-  all_options.insert(all_options.end(), append_options.begin(), append_options.end());
+  phase_timer(const phase_timer &) = delete;
+  phase_timer &operator=(const phase_timer &) = delete;
 
-  // Get comment string for the file extension.
-  std::string comment_str = (comment_str_map.find(file_extension) != comment_str_map.end()) ?
-                            comment_str_map.at(file_extension) : "// ";
+private:
+  timing_phase phase;
+  bool active;
+  LARGE_INTEGER start_wall = {};
+  ULONG64 start_cycles = 0;
+  unsigned long long start_faults = 0;
+};
 
-  // Build final file message.
-  std::string file_message;
-  for (const auto &opt : all_options) {
-    std::string converted_option = convert_option(opt, filename);
-    DEBUG_PRINT("%s%s\n", comment_str.c_str(), converted_option.c_str());
-    file_message += comment_str + converted_option + "\n";
+/**
+ * @brief Prints the counters of every phase that ran to stderr, for --timings=hw.
+ */
+void print_phase_counters() {
+  static const char *names[PHASE_COUNT] = {"config load", "compile", "render", "write"};
+  LARGE_INTEGER frequency;
+  QueryPerformanceFrequency(&frequency);
+  bool cycles = cycles_available.load();
+  bool faults = page_faults_available.load();
+  ERROR_PRINT("touch: hardware counters (cycles per thread, page faults per process)\n");
+  ERROR_PRINT("  %-12s %8s %10s %14s %14s %14s %14s %12s\n", "phase", "calls", "wall ms", "cycles",
+              "instructions", "cache misses", "branch misses", "page faults");
+  for (int i = 0; i < PHASE_COUNT; i++) {
+    const phase_totals &totals = phase_stats[i];
+    if (totals.calls.load() == 0) continue;
+    char cycle_text[32] = "n/a";
+    char fault_text[32] = "n/a";
+    if (cycles) snprintf(cycle_text, sizeof(cycle_text), "%llu", totals.cycles.load());
+    if (faults) snprintf(fault_text, sizeof(fault_text), "%llu", totals.page_faults.load());
+    ERROR_PRINT("  %-12s %8llu %10.3f %14s %14s %14s %14s %12s\n", names[i], totals.calls.load(),
+                totals.wall_ticks.load() * 1000.0 / frequency.QuadPart, cycle_text, "n/a", "n/a", "n/a", fault_text);
   }
+}
 
-  // Add raw code.
-  if (!raw_code.empty()) {
-    // Add a newline before the raw code.
-    file_message += "\n";
-    for (const auto &line : raw_code) {
-      DEBUG_PRINT("%s\n", line.c_str());
+/**
+ * @brief Counters of a long-running touch, reported by the "stats" request of --serve-stdio.
+ */
+struct service_counters {
+  std::atomic<unsigned long long> config_reloads{0};
+  std::atomic<unsigned long long> config_cache_hits{0};   /**< Configurations mapped from the cache. */
+  std::atomic<unsigned long long> config_cache_misses{0}; /**< Configurations parsed and cached again. */
+};
+
+/**
+ * @brief The counters of this process.
+ */
+service_counters service_stats;
+
+/**
+ * @brief A unit of work for an io_executor: a posted callback or an overlapped I/O.
+ *
+ * Tasks derive from OVERLAPPED so that the same object can be handed to overlapped Win32
+ * I/O and comes back out of the completion port when the I/O finishes.
+ */
+struct io_task : OVERLAPPED {
+  io_task() {
+    memset(static_cast<OVERLAPPED *>(this), 0, sizeof(OVERLAPPED));
+  }
+  virtual ~io_task() {}
+
+  /**
+   * @brief Called on an executor thread when the task is dequeued.
+   * @param ok False if the I/O the task was attached to failed.
+   * @param bytes The number of bytes transferred by the I/O.
+   */
+  virtual void run(bool ok, DWORD bytes) = 0;
+};
+
+/**
+ * @brief A small pool of threads serving an I/O completion port, plus a timer queue.
+ *
+ * Any number of operations can be in flight at once: an operation only occupies a thread
+ * while its completion is being processed, not while it waits for the device.
+ */
+class io_executor {
+public:
+  explicit io_executor(unsigned threads) : stopping(false) {
+    port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, threads);
+    timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (timer == NULL) {
+      timer = CreateWaitableTimerExW(NULL, NULL, 0, TIMER_ALL_ACCESS);
+    }
+    timer_changed = CreateEventA(NULL, FALSE, FALSE, NULL);
+    for (unsigned i = 0; i < threads; i++) {
+      workers.emplace_back([this]() { run_completions(); });
+    }
+    timer_thread = std::thread([this]() { run_timers(); });
+  }
+
+  ~io_executor() {
+    {
+      std::lock_guard<std::mutex> lock(timer_mutex);
+      stopping = true;
+    }
+    SetEvent(timer_changed);
+    timer_thread.join();
+    for (size_t i = 0; i < workers.size(); i++) {
+      PostQueuedCompletionStatus(port, 0, STOP_KEY, NULL);
+    }
+    for (std::thread &worker : workers) {
+      worker.join();
+    }
+    CloseHandle(timer_changed);
+    CloseHandle(timer);
+    CloseHandle(port);
+  }
+
+  /**
+   * @brief Associates a handle opened with FILE_FLAG_OVERLAPPED with the completion port.
+   */
+  bool attach(HANDLE file) {
+    return CreateIoCompletionPort(file, port, 0, 0) != NULL;
+  }
+
+  /**
+   * @brief Runs a task on one of the executor threads.
+   */
+  void post(io_task *task) {
+    PostQueuedCompletionStatus(port, 0, 0, task);
+  }
+
+  /**
+   * @brief Runs a task on one of the executor threads after a delay.
+   */
+  void post_after(unsigned long long microseconds, io_task *task) {
+    if (microseconds == 0) {
+      post(task);
+      return;
+    }
+    auto due = std::chrono::steady_clock::now() + std::chrono::microseconds(microseconds);
+    bool earliest;
+    {
+      std::lock_guard<std::mutex> lock(timer_mutex);
+      earliest = timers.empty() || due < timers.top().due;
+      timers.push({due, task});
+    }
+    if (earliest) {
+      SetEvent(timer_changed);
+    }
+  }
+
+  /**
+   * @brief The number of threads serving completions.
+   */
+  size_t thread_count() const {
+    return workers.size();
+  }
+
+private:
+  static const ULONG_PTR STOP_KEY = 1;
+
+  struct pending_timer {
+    std::chrono::steady_clock::time_point due;
+    io_task *task;
+    bool operator>(const pending_timer &other) const { return due > other.due; }
+  };
+
+  void run_completions() {
+    for (;;) {
+      DWORD bytes = 0;
+      ULONG_PTR key = 0;
+      LPOVERLAPPED overlapped = NULL;
+      BOOL ok = GetQueuedCompletionStatus(port, &bytes, &key, &overlapped, INFINITE);
+      if (overlapped == NULL) {
+        if (key == STOP_KEY) return;
+        continue;
+      }
+      static_cast<io_task *>(overlapped)->run(ok != FALSE, bytes);
+    }
+  }
+
+  void run_timers() {
+    for (;;) {
+      std::vector<io_task *> expired;
+      long long wait_us = -1;
+      {
+        std::lock_guard<std::mutex> lock(timer_mutex);
+        if (stopping) return;
+        auto now = std::chrono::steady_clock::now();
+        while (!timers.empty() && timers.top().due <= now) {
+          expired.push_back(timers.top().task);
+          timers.pop();
+        }
+        if (!timers.empty()) {
+          wait_us = std::chrono::duration_cast<std::chrono::microseconds>(timers.top().due - now).count() + 1;
+        }
+      }
+      for (io_task *task : expired) {
+        post(task);
+      }
+      if (wait_us < 0) {
+        WaitForSingleObject(timer_changed, INFINITE);
+        continue;
+      }
+      LARGE_INTEGER due;
+      due.QuadPart = -(LONGLONG)(wait_us * 10); // Relative time in 100 ns units.
+      SetWaitableTimer(timer, &due, 0, NULL, NULL, FALSE);
+      HANDLE handles[] = {timer, timer_changed};
+      WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+    }
+  }
+
+  HANDLE port;
+  HANDLE timer;
+  HANDLE timer_changed; /**< Signaled when an earlier timer is added or the executor stops. */
+  std::vector<std::thread> workers;
+  std::thread timer_thread;
+  std::mutex timer_mutex;
+  std::priority_queue<pending_timer, std::vector<pending_timer>, std::greater<pending_timer>> timers;
+  bool stopping;
+};
+
+/**
+ * @brief Opaque handle to a file opened through a filesystem backend.
+ */
+typedef void *fs_handle;
+
+/**
+ * @brief Splits a path into its parent directory and final component.
+ *
+ * @param path The path to split.
+ * @param name If not null, receives the final component.
+ * @return The parent directory, or an empty string for a path without a directory.
+ */
+std::string split_parent(const std::string &path, std::string *name = nullptr) {
+  std::string::size_type pos = path.find_last_of("\\/");
+  if (name != nullptr) {
+    *name = (pos == std::string::npos) ? path : path.substr(pos + 1);
+  }
+  if (pos == std::string::npos) return "";
+  // Keep the separator for root directories such as "/" or "C:\".
+  if (pos == 0 || path[pos - 1] == ':') return path.substr(0, pos + 1);
+  return path.substr(0, pos);
+}
+
+/**
+ * @brief Joins a directory and a name, the inverse of split_parent.
+ */
+std::string join_path(const std::string &directory, const std::string &name) {
+  if (directory.empty()) return name;
+  char last = directory.back();
+  return (last == '\\' || last == '/') ? directory + name : directory + "\\" + name;
+}
+
+/**
+ * @brief Metadata returned by filesystem::stat.
+ */
+struct file_stat {
+  bool is_directory;       /**< True if the path names a directory. */
+  unsigned long long size; /**< File size in bytes. */
+  time_t mtime;            /**< Last modification time. */
+};
+
+/**
+ * @brief State of an asynchronous filesystem operation, completed on an io_executor.
+ */
+struct fs_request : io_task {
+  bool ok = false;                /**< Result of the operation. */
+  fs_handle handle = nullptr;     /**< The file created by create_async(). */
+  file_stat stat = {};            /**< The metadata returned by stat_async(). */
+  unsigned long long offset = 0;  /**< The file offset for write_async(). */
+
+  void run(bool io_ok, DWORD bytes) override {
+    (void)bytes;
+    if (!io_ok) ok = false;
+    complete();
+  }
+
+  /**
+   * @brief Called on an executor thread when the operation has finished.
+   */
+  virtual void complete() = 0;
+};
+
+/**
+ * @brief Interface for all file system access performed by touch.
+ *
+ * Keeping every I/O operation behind this interface lets the render logic run against
+ * something other than the local disk, e.g. the in-memory backend used for benchmarking.
+ */
+class filesystem {
+public:
+  virtual ~filesystem() {}
+
+  /**
+   * @brief Creates (or truncates) a file and opens it for writing.
+   * @return A handle to the file, or nullptr on failure.
+   */
+  virtual fs_handle create(const std::string &path) = 0;
+
+  /**
+   * @brief Writes a buffer to a file opened with create().
+   *
+   * Backends may defer the actual write until close() to avoid copying, so the buffer
+   * must stay valid and unchanged until the file has been closed.
+   *
+   * @return True if the whole buffer was written.
+   */
+  virtual bool write(fs_handle file, const char *data, size_t size) = 0;
+
+  /**
+   * @brief Like write(), but the buffer may be reused as soon as the call returns.
+   *
+   * Backends that defer writes until close() have to copy the buffer; the default is
+   * for backends that consume written data right away.
+   *
+   * @return True if the whole buffer was written.
+   */
+  virtual bool write_transient(fs_handle file, const char *data, size_t size) {
+    return write(file, data, size);
+  }
+
+  /**
+   * @brief Appends size zero bytes to a file opened with create().
+   *
+   * The default writes the zeros; backends override it to change the file size
+   * without writing anything.
+   *
+   * @param sparse True to leave the range unallocated where the file system supports it.
+   * @return True if the file was extended.
+   */
+  virtual bool extend(fs_handle file, unsigned long long size, bool sparse) {
+    (void)sparse;
+    while (size > 0) {
+      size_t chunk = (size_t)std::min<unsigned long long>(size, FILL_BLOCK_SIZE);
+      if (!write(file, zero_fill_block(), chunk)) return false;
+      size -= chunk;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Closes a file opened with create().
+   * @return True if all written data was committed.
+   */
+  virtual bool close(fs_handle file) = 0;
+
+  /**
+   * @brief Retrieves metadata for a path.
+   * @return True if the path exists, in which case out is filled in.
+   */
+  virtual bool stat(const std::string &path, file_stat *out) = 0;
+
+  /**
+   * @brief Sets the access and modification time of an existing path.
+   * @return True on success.
+   */
+  virtual bool utimes(const std::string &path, time_t mtime) = 0;
+
+  /**
+   * @brief Creates a single directory. The parent directory must already exist.
+   * @return True on success.
+   */
+  virtual bool mkdir(const std::string &path) = 0;
+
+  /**
+   * @brief Deletes a file.
+   * @return True on success.
+   */
+  virtual bool remove(const std::string &path) = 0;
+
+  /**
+   * @brief Deletes an empty directory.
+   * @return True on success.
+   */
+  virtual bool rmdir(const std::string &path) = 0;
+
+  /**
+   * @brief Moves a file to a new path, replacing any file that already exists there.
+   * @return True on success.
+   */
+  virtual bool rename(const std::string &from, const std::string &to) = 0;
+
+  /**
+   * @brief Opens a directory so files can be created relative to it with create_at().
+   *
+   * Creating many files through one open directory saves resolving the full path for
+   * every file. The default implementation only remembers the path.
+   *
+   * @param path The directory, or an empty string for the current directory.
+   * @return A directory handle, or nullptr on failure.
+   */
+  virtual fs_handle open_dir(const std::string &path) {
+    return new std::string(path);
+  }
+
+  /**
+   * @brief Like create(), but relative to a directory opened with open_dir().
+   * @param directory The directory handle.
+   * @param name The file name, without any directory components.
+   */
+  virtual fs_handle create_at(fs_handle directory, const std::string &name) {
+    return create(join_path(*static_cast<std::string *>(directory), name));
+  }
+
+  /**
+   * @brief Closes a directory handle returned by open_dir().
+   */
+  virtual void close_dir(fs_handle directory) {
+    delete static_cast<std::string *>(directory);
+  }
+
+  // Asynchronous operations. Each one completes its request on the executor, once, with
+  // the result stored in the request. The defaults run the synchronous operation
+  // in place, backends override them where the platform or the simulation can do better.
+  // Files created with create_async() may only be used with write_async() and close_async().
+
+  virtual void stat_async(io_executor &executor, const std::string &path, fs_request *request) {
+    request->ok = stat(path, &request->stat);
+    executor.post(request);
+  }
+
+  virtual void create_async(io_executor &executor, const std::string &path, fs_request *request) {
+    request->handle = create(path);
+    request->ok = request->handle != nullptr;
+    executor.post(request);
+  }
+
+  virtual void write_async(io_executor &executor, fs_handle file, const char *data, size_t size,
+                           fs_request *request) {
+    request->ok = write(file, data, size);
+    executor.post(request);
+  }
+
+  virtual void close_async(io_executor &executor, fs_handle file, fs_request *request) {
+    request->ok = close(file);
+    executor.post(request);
+  }
+};
+
+/**
+ * @brief Filesystem backend for the local file system, implemented with the Win32 API.
+ *
+ * Files are written in binary mode, the rendered message is written byte for byte.
+ */
+class native_filesystem : public filesystem {
+public:
+  fs_handle create(const std::string &path) override {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL,
+                              CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    return (file == INVALID_HANDLE_VALUE) ? nullptr : (fs_handle)file;
+  }
+
+  bool write(fs_handle file, const char *data, size_t size) override {
+    while (size > 0) {
+      // WriteFile takes a 32-bit length, so very large buffers are written in chunks.
+      DWORD chunk = (size > 0x40000000) ? 0x40000000 : (DWORD)size;
+      DWORD written = 0;
+      if (!WriteFile((HANDLE)file, data, chunk, &written, NULL) || written == 0) {
+        return false;
+      }
+      data += written;
+      size -= written;
+    }
+    return true;
+  }
+
+  bool extend(fs_handle file, unsigned long long size, bool sparse) override {
+    if (sparse) {
+      // Where sparse files aren't supported (e.g. FAT) the range is simply allocated.
+      DWORD returned = 0;
+      DeviceIoControl((HANDLE)file, FSCTL_SET_SPARSE, NULL, 0, NULL, 0, &returned, NULL);
+    }
+    // Moving the end of file allocates the range without writing it; NTFS returns zeros
+    // for everything beyond the data actually written.
+    LARGE_INTEGER distance;
+    distance.QuadPart = (LONGLONG)size;
+    return SetFilePointerEx((HANDLE)file, distance, NULL, FILE_CURRENT) && SetEndOfFile((HANDLE)file);
+  }
+
+  bool close(fs_handle file) override {
+    return CloseHandle((HANDLE)file) != 0;
+  }
+
+  bool stat(const std::string &path, file_stat *out) override {
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data)) {
+      return false;
+    }
+    out->is_directory = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+    out->size = ((unsigned long long)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+    out->mtime = filetime_to_time_t(data.ftLastWriteTime);
+    return true;
+  }
+
+  bool utimes(const std::string &path, time_t mtime) override {
+    // FILE_FLAG_BACKUP_SEMANTICS is required to open directories.
+    HANDLE file = CreateFileA(path.c_str(), FILE_WRITE_ATTRIBUTES,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                              OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+      return false;
+    }
+    FILETIME filetime = time_t_to_filetime(mtime);
+    bool ok = SetFileTime(file, NULL, &filetime, &filetime) != 0;
+    CloseHandle(file);
+    return ok;
+  }
+
+  bool mkdir(const std::string &path) override {
+    return CreateDirectoryA(path.c_str(), NULL) != 0;
+  }
+
+  bool remove(const std::string &path) override {
+    return DeleteFileA(path.c_str()) != 0;
+  }
+
+  bool rmdir(const std::string &path) override {
+    return RemoveDirectoryA(path.c_str()) != 0;
+  }
+
+  bool rename(const std::string &from, const std::string &to) override {
+    // Within a volume this is a rename; across volumes Windows falls back to a copy.
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_COPY_ALLOWED) != 0;
+  }
+
+  void create_async(io_executor &executor, const std::string &path, fs_request *request) override {
+    // Windows has no asynchronous open, but the handle is opened for overlapped I/O so its
+    // writes complete through the executor's completion port.
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL,
+                              CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, NULL);
+    request->ok = file != INVALID_HANDLE_VALUE && executor.attach(file);
+    if (!request->ok && file != INVALID_HANDLE_VALUE) {
+      CloseHandle(file);
+    }
+    request->handle = request->ok ? (fs_handle)file : nullptr;
+    executor.post(request);
+  }
+
+  void write_async(io_executor &executor, fs_handle file, const char *data, size_t size,
+                   fs_request *request) override {
+    if (size > 0xFFFFFFFFULL) {
+      request->ok = false;
+      executor.post(request);
+      return;
+    }
+    request->Offset = (DWORD)request->offset;
+    request->OffsetHigh = (DWORD)(request->offset >> 32);
+    request->ok = true;
+    // The completion is queued to the port whether or not the write finishes right away.
+    if (!WriteFile((HANDLE)file, data, (DWORD)size, NULL, request) && GetLastError() != ERROR_IO_PENDING) {
+      request->ok = false;
+      executor.post(request);
+    }
+  }
+
+  fs_handle open_dir(const std::string &path) override {
+    native_dir *directory = new native_dir;
+    directory->path = path;
+    directory->handle = INVALID_HANDLE_VALUE;
+    if (nt_create_file() != nullptr) {
+      directory->handle = CreateFileA(path.empty() ? "." : path.c_str(),
+                                      FILE_LIST_DIRECTORY | FILE_TRAVERSE | SYNCHRONIZE,
+                                      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                                      OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+    }
+    return directory;
+  }
+
+  fs_handle create_at(fs_handle directory, const std::string &name) override {
+    native_dir *dir = static_cast<native_dir *>(directory);
+    if (dir->handle == INVALID_HANDLE_VALUE) {
+      return create(join_path(dir->path, name));
+    }
+    // NtCreateFile is the only Win32 way to open a file relative to a directory handle,
+    // the equivalent of openat(). The name is looked up in the directory directly
+    // instead of walking the full path again.
+    int length = MultiByteToWideChar(CP_ACP, 0, name.c_str(), (int)name.size(), NULL, 0);
+    std::wstring wide_name(length, L'\0');
+    MultiByteToWideChar(CP_ACP, 0, name.c_str(), (int)name.size(), &wide_name[0], length);
+    UNICODE_STRING object_name;
+    object_name.Buffer = &wide_name[0];
+    object_name.Length = (USHORT)(wide_name.size() * sizeof(wchar_t));
+    object_name.MaximumLength = object_name.Length;
+    OBJECT_ATTRIBUTES attributes;
+    InitializeObjectAttributes(&attributes, &object_name, OBJ_CASE_INSENSITIVE, dir->handle, NULL);
+    IO_STATUS_BLOCK status_block;
+    HANDLE file = NULL;
+    NTSTATUS status = nt_create_file()(&file, GENERIC_WRITE | SYNCHRONIZE, &attributes, &status_block,
+                                       NULL, FILE_ATTRIBUTE_NORMAL, FILE_SHARE_READ, FILE_OVERWRITE_IF,
+                                       FILE_NON_DIRECTORY_FILE | FILE_SYNCHRONOUS_IO_NONALERT, NULL, 0);
+    return (status < 0) ? nullptr : (fs_handle)file;
+  }
+
+  void close_dir(fs_handle directory) override {
+    native_dir *dir = static_cast<native_dir *>(directory);
+    if (dir->handle != INVALID_HANDLE_VALUE) {
+      CloseHandle(dir->handle);
+    }
+    delete dir;
+  }
+
+private:
+  /**
+   * @brief An open directory, returned as the fs_handle by open_dir().
+   */
+  struct native_dir {
+    std::string path;
+    HANDLE handle; /**< INVALID_HANDLE_VALUE if files are created by full path. */
+  };
+
+  typedef NTSTATUS (NTAPI *nt_create_file_fn)(PHANDLE, ACCESS_MASK, POBJECT_ATTRIBUTES, PIO_STATUS_BLOCK,
+                                              PLARGE_INTEGER, ULONG, ULONG, ULONG, ULONG, PVOID, ULONG);
+
+  /**
+   * @brief Looks up NtCreateFile in ntdll.dll, which has no import library in the SDK.
+   */
+  static nt_create_file_fn nt_create_file() {
+    static nt_create_file_fn function =
+      (nt_create_file_fn)(void *)GetProcAddress(GetModuleHandleA("ntdll.dll"), "NtCreateFile");
+    return function;
+  }
+};
+
+/**
+ * @brief Latency injected into every operation of the in-memory filesystem.
+ *
+ * All values default to zero, which disables the simulation. Setting them makes the
+ * in-memory backend behave like a slow (e.g. network) file system.
+ */
+struct latency_model {
+  unsigned metadata_us = 0;  /**< Delay for create, close, stat, utimes and mkdir. */
+  unsigned write_us = 0;     /**< Fixed delay for every write call. */
+  unsigned bytes_per_us = 0; /**< Write bandwidth in bytes per microsecond, 0 for unlimited. */
+  unsigned channels = 0;     /**< Operations the device serves in parallel, 0 for unlimited. */
+  unsigned dir_lock_us = 0;  /**< Time a create holds the lock of its parent directory. */
+
+  /**
+   * @brief Simulates the latency of a metadata operation.
+   */
+  void on_metadata() const {
+    sleep_microseconds(metadata_us);
+  }
+
+  /**
+   * @brief The latency of writing size bytes, in microseconds.
+   */
+  unsigned long long write_delay(size_t size) const {
+    unsigned long long delay = write_us;
+    if (bytes_per_us != 0) {
+      delay += size / bytes_per_us;
+    }
+    return delay;
+  }
+
+  /**
+   * @brief Simulates the latency of writing size bytes.
+   */
+  void on_write(size_t size) const {
+    sleep_microseconds(write_delay(size));
+  }
+};
+
+/**
+ * @brief Parses a latency model specification.
+ *
+ * The format is METADATA_US[,WRITE_US[,BYTES_PER_US[,CHANNELS[,DIR_LOCK_US]]]], e.g.
+ * "2000,500,100,16" for a network share with 2 ms metadata operations, roughly 100 MB/s
+ * of bandwidth and 16 requests in flight before further requests queue up.
+ *
+ * @param spec The specification string.
+ * @param out The latency model to fill in.
+ * @return True if the specification is valid.
+ */
+bool parse_latency_model(const char *spec, latency_model *out) {
+  unsigned *fields[] = {&out->metadata_us, &out->write_us, &out->bytes_per_us, &out->channels, &out->dir_lock_us};
+  for (unsigned *field : fields) {
+    char *end = nullptr;
+    unsigned long value = strtoul(spec, &end, 10);
+    if (end == spec) return false;
+    *field = (unsigned)value;
+    if (*end == '\0') return true;
+    if (*end != ',') return false;
+    spec = end + 1;
+  }
+  return false;
+}
+
+/**
+ * @brief Filesystem backend that keeps all files in memory.
+ *
+ * Nothing is written to disk, which makes it possible to measure the cost of rendering
+ * and scheduling without disk noise. An optional latency model simulates slow storage.
+ */
+class memory_filesystem : public filesystem {
+public:
+  explicit memory_filesystem(const latency_model &latency = latency_model()) : latency(latency), busy_channels(0) {}
+
+  fs_handle create(const std::string &path) override {
+    channel_guard channel(*this);
+    latency.on_metadata();
+    std::string key = normalize_path(path);
+    hold_directory_lock(key);
+    return create_entry(key);
+  }
+
+  bool write(fs_handle file, const char *data, size_t size) override {
+    channel_guard channel(*this);
+    latency.on_write(size);
+    // Data is staged in the handle and committed on close, so writers never share a lock.
+    static_cast<memory_file *>(file)->content.append(data, size);
+    return true;
+  }
+
+  bool close(fs_handle file) override {
+    channel_guard channel(*this);
+    latency.on_metadata();
+    commit(static_cast<memory_file *>(file));
+    return true;
+  }
+
+  bool stat(const std::string &path, file_stat *out) override {
+    channel_guard channel(*this);
+    latency.on_metadata();
+    return lookup(normalize_path(path), out);
+  }
+
+  // The asynchronous operations take effect immediately and complete after the simulated
+  // latency, so waiting costs a timer rather than a thread. Channels and directory locks
+  // are not simulated for them.
+
+  void stat_async(io_executor &executor, const std::string &path, fs_request *request) override {
+    request->ok = lookup(normalize_path(path), &request->stat);
+    executor.post_after(latency.metadata_us, request);
+  }
+
+  void create_async(io_executor &executor, const std::string &path, fs_request *request) override {
+    request->handle = create_entry(normalize_path(path));
+    request->ok = request->handle != nullptr;
+    executor.post_after(latency.metadata_us, request);
+  }
+
+  void write_async(io_executor &executor, fs_handle file, const char *data, size_t size,
+                   fs_request *request) override {
+    static_cast<memory_file *>(file)->content.append(data, size);
+    request->ok = true;
+    executor.post_after(latency.write_delay(size), request);
+  }
+
+  void close_async(io_executor &executor, fs_handle file, fs_request *request) override {
+    commit(static_cast<memory_file *>(file));
+    request->ok = true;
+    executor.post_after(latency.metadata_us, request);
+  }
+
+  bool utimes(const std::string &path, time_t mtime) override {
+    channel_guard channel(*this);
+    latency.on_metadata();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(normalize_path(path));
+    if (it == entries.end()) return false;
+    it->second.mtime = mtime;
+    return true;
+  }
+
+  bool mkdir(const std::string &path) override {
+    channel_guard channel(*this);
+    latency.on_metadata();
+    std::string key = normalize_path(path);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!parent_exists(key) || entries.find(key) != entries.end()) return false;
+    memory_entry &entry = entries[key];
+    entry.is_directory = true;
+    entry.mtime = time(0);
+    return true;
+  }
+
+  bool remove(const std::string &path) override {
+    channel_guard channel(*this);
+    latency.on_metadata();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(normalize_path(path));
+    if (it == entries.end() || it->second.is_directory) return false;
+    entries.erase(it);
+    return true;
+  }
+
+  bool rmdir(const std::string &path) override {
+    channel_guard channel(*this);
+    latency.on_metadata();
+    std::string key = normalize_path(path);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end() || !it->second.is_directory) return false;
+    // Entries are not stored as a tree, so look for children by prefix.
+    std::string prefix = key + "/";
+    for (const auto &entry : entries) {
+      if (entry.first.compare(0, prefix.size(), prefix) == 0) return false;
+    }
+    entries.erase(it);
+    return true;
+  }
+
+  bool rename(const std::string &from, const std::string &to) override {
+    channel_guard channel(*this);
+    latency.on_metadata();
+    std::string from_key = normalize_path(from);
+    std::string to_key = normalize_path(to);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(from_key);
+    if (it == entries.end() || it->second.is_directory || !parent_exists(to_key)) return false;
+    auto target = entries.find(to_key);
+    if (target != entries.end() && target->second.is_directory) return false;
+    memory_entry moved = std::move(it->second);
+    entries.erase(it);
+    entries[to_key] = std::move(moved);
+    return true;
+  }
+
+private:
+  /**
+   * @brief A file or directory stored in memory.
+   */
+  struct memory_entry {
+    bool is_directory = false;
+    std::string content;
+    time_t mtime = 0;
+  };
+
+  /**
+   * @brief An open file, returned as the fs_handle.
+   */
+  struct memory_file {
+    std::string path;
+    std::string content;
+  };
+
+  /**
+   * @brief Occupies one of the simulated device channels for the lifetime of the guard.
+   *
+   * When all channels are busy further operations queue, so latency grows with the
+   * number of operations in flight the same way it does on a saturated device.
+   */
+  class channel_guard {
+  public:
+    explicit channel_guard(memory_filesystem &fs) : fs(fs) {
+      if (fs.latency.channels == 0) return;
+      std::unique_lock<std::mutex> lock(fs.channel_mutex);
+      fs.channel_free.wait(lock, [&] { return fs.busy_channels < fs.latency.channels; });
+      fs.busy_channels++;
+    }
+    ~channel_guard() {
+      if (fs.latency.channels == 0) return;
+      {
+        std::lock_guard<std::mutex> lock(fs.channel_mutex);
+        fs.busy_channels--;
+      }
+      fs.channel_free.notify_one();
+    }
+  private:
+    memory_filesystem &fs;
+  };
+
+  /**
+   * @brief Creates or truncates a file entry and returns an open handle to it.
+   */
+  fs_handle create_entry(const std::string &key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!parent_exists(key)) return nullptr;
+    auto it = entries.find(key);
+    if (it != entries.end() && it->second.is_directory) return nullptr;
+    memory_entry &entry = entries[key];
+    entry.is_directory = false;
+    entry.content.clear();
+    entry.mtime = time(0);
+    return new memory_file{key, std::string()};
+  }
+
+  /**
+   * @brief Stores the content staged in an open file and releases the handle.
+   */
+  void commit(memory_file *open_file) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      memory_entry &entry = entries[open_file->path];
+      entry.content.swap(open_file->content);
+      entry.mtime = time(0);
+    }
+    delete open_file;
+  }
+
+  /**
+   * @brief Looks up the metadata of a normalized path.
+   */
+  bool lookup(const std::string &key, file_stat *out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) return false;
+    out->is_directory = it->second.is_directory;
+    out->size = it->second.content.size();
+    out->mtime = it->second.mtime;
+    return true;
+  }
+
+  /**
+   * @brief Simulates the parent directory's lock being held while an entry is inserted.
+   */
+  void hold_directory_lock(const std::string &path) {
+    if (latency.dir_lock_us == 0) return;
+    std::mutex *directory_lock;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      std::unique_ptr<std::mutex> &slot = directory_locks[split_parent(path)];
+      if (!slot) slot.reset(new std::mutex());
+      directory_lock = slot.get();
+    }
+    std::lock_guard<std::mutex> lock(*directory_lock);
+    sleep_microseconds(latency.dir_lock_us);
+  }
+
+  /**
+   * @brief Normalizes path separators so "a\b" and "a/b" name the same entry.
+   */
+  static std::string normalize_path(std::string path) {
+    for (char &c : path) {
+      if (c == '\\') c = '/';
+    }
+    while (path.compare(0, 2, "./") == 0) {
+      path.erase(0, 2);
+    }
+    return path;
+  }
+
+  /**
+   * @brief Checks that the parent directory of a normalized path exists. Must hold mutex.
+   */
+  bool parent_exists(const std::string &path) const {
+    std::string::size_type pos = path.find_last_of('/');
+    if (pos == std::string::npos || pos == 0 || path[pos - 1] == ':') return true;
+    auto it = entries.find(path.substr(0, pos));
+    return it != entries.end() && it->second.is_directory;
+  }
+
+  latency_model latency;
+  std::mutex mutex;
+  std::unordered_map<std::string, memory_entry> entries;
+  std::mutex channel_mutex;
+  std::condition_variable channel_free;
+  unsigned busy_channels;
+  std::unordered_map<std::string, std::unique_ptr<std::mutex>> directory_locks;
+};
+
+/**
+ * @brief Filesystem backend that streams every created file into a tar archive.
+ *
+ * Entries are written in POSIX ustar format, with a pax extended header in front of
+ * entries whose path or size does not fit in the ustar fields. Nothing is created on
+ * disk, so generating a scaffold costs a few buffered writes instead of a handful of
+ * metadata system calls per file.
+ *
+ * The content of a file is not copied: write() only records the buffer, and close()
+ * computes the header from the total size and emits the header followed by the
+ * recorded segments. Small pieces are gathered in an output buffer, large segments
+ * are written straight from the caller's memory.
+ */
+class tar_filesystem : public filesystem {
+public:
+  /**
+   * @brief Creates a tar backend writing to a handle.
+   * @param out The handle to write the archive to, e.g. standard output.
+   * @param owns_handle True if the handle should be closed by finish().
+   */
+  tar_filesystem(HANDLE out, bool owns_handle) : out(out), owns_handle(owns_handle), failed(false) {
+    buffer.reserve(BUFFER_SIZE);
+  }
+
+  fs_handle create(const std::string &path) override {
+    std::string name = member_name(path);
+    if (name.empty()) return nullptr;
+    tar_entry *entry = new tar_entry;
+    entry->name = name;
+    entry->size = 0;
+    entry->mtime = time(0);
+    return entry;
+  }
+
+  bool write(fs_handle file, const char *data, size_t size) override {
+    tar_entry *entry = static_cast<tar_entry *>(file);
+    entry->segments.push_back({data, size});
+    entry->size += size;
+    return true;
+  }
+
+  bool write_transient(fs_handle file, const char *data, size_t size) override {
+    tar_entry *entry = static_cast<tar_entry *>(file);
+    entry->copies.emplace_back(data, size);
+    return write(file, entry->copies.back().data(), size);
+  }
+
+  bool close(fs_handle file) override {
+    tar_entry *entry = static_cast<tar_entry *>(file);
+    bool ok;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ok = emit_entry(*entry, '0');
+      members[entry->name] = false;
+    }
+    delete entry;
+    return ok;
+  }
+
+  bool stat(const std::string &path, file_stat *out) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = members.find(member_name(path));
+    if (it == members.end()) return false;
+    out->is_directory = it->second;
+    out->size = 0;
+    out->mtime = 0;
+    return true;
+  }
+
+  bool utimes(const std::string &path, time_t mtime) override {
+    // Entries are streamed as soon as they are closed, so their time can't be changed.
+    (void)mtime;
+    std::lock_guard<std::mutex> lock(mutex);
+    return members.find(member_name(path)) != members.end();
+  }
+
+  bool mkdir(const std::string &path) override {
+    tar_entry entry;
+    entry.name = member_name(path);
+    if (entry.name.empty()) return false;
+    entry.name += '/';
+    entry.size = 0;
+    entry.mtime = time(0);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (members.find(member_name(path)) != members.end()) return false;
+    members[member_name(path)] = true;
+    return emit_entry(entry, '5');
+  }
+
+  // Members are streamed out as soon as they are complete and can't be taken back.
+
+  bool remove(const std::string &path) override {
+    (void)path;
+    return false;
+  }
+
+  bool rmdir(const std::string &path) override {
+    (void)path;
+    return false;
+  }
+
+  bool rename(const std::string &from, const std::string &to) override {
+    (void)from;
+    (void)to;
+    return false;
+  }
+
+  /**
+   * @brief Writes the end-of-archive marker and flushes all buffered output.
+   * @return True if the whole archive was written successfully.
+   */
+  bool finish() {
+    std::lock_guard<std::mutex> lock(mutex);
+    append(zero_block, BLOCK_SIZE);
+    append(zero_block, BLOCK_SIZE);
+    flush();
+    if (owns_handle) {
+      failed |= CloseHandle(out) == 0;
+    }
+    return !failed;
+  }
+
+private:
+  static const size_t BLOCK_SIZE = 512;
+  static const size_t BUFFER_SIZE = 1 << 20;      /**< Size of the output buffer. */
+  static const size_t DIRECT_WRITE_SIZE = 1 << 16; /**< Segments this large bypass the buffer. */
+  static const char zero_block[BLOCK_SIZE];
+
+  /**
+   * @brief A piece of file content, owned by the caller until the entry is closed.
+   */
+  struct segment {
+    const char *data;
+    size_t size;
+  };
+
+  /**
+   * @brief An archive member that has been created but not yet emitted.
+   */
+  struct tar_entry {
+    std::string name;
+    unsigned long long size;
+    time_t mtime;
+    std::vector<segment> segments;
+    std::deque<std::string> copies; /**< Buffers of write_transient(), which keep their place. */
+  };
+
+  /**
+   * @brief Converts a path to a relative archive member name using forward slashes.
+   */
+  static std::string member_name(const std::string &path) {
+    std::string name = path;
+    for (char &c : name) {
+      if (c == '\\') c = '/';
+    }
+    // Archive members must be relative: drop drive letters, leading slashes and "./".
+    if (name.size() >= 2 && name[1] == ':') name.erase(0, 2);
+    while (!name.empty() && name[0] == '/') name.erase(0, 1);
+    while (name.compare(0, 2, "./") == 0) name.erase(0, 2);
+    while (!name.empty() && name.back() == '/') name.pop_back();
+    return name;
+  }
+
+  /**
+   * @brief Writes value as a zero-padded octal number filling a header field.
+   * @return False if the value does not fit in the field.
+   */
+  static bool put_octal(char *field, size_t width, unsigned long long value) {
+    // The last byte of each numeric field is a terminating NUL.
+    for (size_t i = width - 1; i-- > 0;) {
+      field[i] = (char)('0' + (value & 7));
+      value >>= 3;
+    }
+    field[width - 1] = '\0';
+    return value == 0;
+  }
+
+  /**
+   * @brief Fills in a ustar header block.
+   */
+  static void build_header(char *header, const std::string &name, const std::string &prefix,
+                           unsigned long long size, time_t mtime, char typeflag) {
+    memset(header, 0, BLOCK_SIZE);
+    memcpy(header, name.data(), name.size() < 100 ? name.size() : 100);
+    put_octal(header + 100, 8, typeflag == '5' ? 0755 : 0644); // mode
+    put_octal(header + 108, 8, 0);                             // uid
+    put_octal(header + 116, 8, 0);                             // gid
+    put_octal(header + 124, 12, size);
+    put_octal(header + 136, 12, (unsigned long long)mtime);
+    header[156] = typeflag;
+    memcpy(header + 257, "ustar", 6);                          // magic
+    memcpy(header + 263, "00", 2);                             // version
+    memcpy(header + 345, prefix.data(), prefix.size() < 155 ? prefix.size() : 155);
+
+    // The checksum is computed with the checksum field itself filled with spaces.
+    memset(header + 148, ' ', 8);
+    unsigned checksum = 0;
+    for (size_t i = 0; i < BLOCK_SIZE; i++) {
+      checksum += (unsigned char)header[i];
+    }
+    put_octal(header + 148, 7, checksum);
+    header[155] = ' ';
+  }
+
+  /**
+   * @brief Splits a member name into the ustar prefix and name fields.
+   * @return False if the name can't be represented without a pax header.
+   */
+  static bool split_name(const std::string &full, std::string *prefix, std::string *name) {
+    if (full.size() <= 100) {
+      prefix->clear();
+      *name = full;
+      return true;
+    }
+    // The prefix is joined to the name with an implicit '/', so split on a slash.
+    std::string::size_type pos = full.rfind('/', 155);
+    while (pos != std::string::npos && pos > 0) {
+      if (full.size() - pos - 1 <= 100) {
+        *prefix = full.substr(0, pos);
+        *name = full.substr(pos + 1);
+        return !name->empty();
+      }
+      pos = full.rfind('/', pos - 1);
+    }
+    return false;
+  }
+
+  /**
+   * @brief Appends one "LENGTH key=value\n" pax record, where LENGTH counts itself.
+   */
+  static void add_pax_record(std::string *records, const std::string &key, const std::string &value) {
+    size_t payload = key.size() + value.size() + 3; // ' ', '=' and '\n'
+    size_t length = payload + 1;
+    while (std::to_string(length).size() + payload != length) {
+      length = std::to_string(length).size() + payload;
+    }
+    *records += std::to_string(length) + " " + key + "=" + value + "\n";
+  }
+
+  /**
+   * @brief Emits the header, content and padding of an entry. Must hold mutex.
+   */
+  bool emit_entry(const tar_entry &entry, char typeflag) {
+    char header[BLOCK_SIZE];
+    std::string prefix, name;
+    bool fits_name = split_name(entry.name, &prefix, &name);
+    bool fits_size = entry.size < (1ULL << 33); // 11 octal digits.
+    if (!fits_name || !fits_size) {
+      std::string records;
+      if (!fits_name) add_pax_record(&records, "path", entry.name);
+      if (!fits_size) add_pax_record(&records, "size", std::to_string(entry.size));
+      std::string base = entry.name.substr(entry.name.find_last_of('/', entry.name.size() - 2) + 1);
+      std::string pax_name = ("PaxHeaders/" + base).substr(0, 100);
+      build_header(header, pax_name, "", records.size(), entry.mtime, 'x');
+      append(header, BLOCK_SIZE);
+      append(records.data(), records.size());
+      pad(records.size());
+      // The ustar fields still get a best-effort value for readers without pax support.
+      if (!fits_name) {
+        prefix.clear();
+        name = entry.name.substr(0, 100);
+      }
+    }
+    build_header(header, name, prefix, fits_size ? entry.size : 0, entry.mtime, typeflag);
+    append(header, BLOCK_SIZE);
+    for (const segment &seg : entry.segments) {
+      append(seg.data, seg.size);
+    }
+    pad(entry.size);
+    return !failed;
+  }
+
+  /**
+   * @brief Appends zero bytes up to the next block boundary after size bytes of content.
+   */
+  void pad(unsigned long long size) {
+    size_t remainder = (size_t)(size % BLOCK_SIZE);
+    if (remainder != 0) {
+      append(zero_block, BLOCK_SIZE - remainder);
+    }
+  }
+
+  /**
+   * @brief Queues data for output. Large buffers are written without being copied.
+   */
+  void append(const char *data, size_t size) {
+    if (size >= DIRECT_WRITE_SIZE) {
+      flush();
+      write_out(data, size);
+      return;
+    }
+    if (buffer.size() + size > BUFFER_SIZE) {
+      flush();
+    }
+    buffer.append(data, size);
+  }
+
+  /**
+   * @brief Writes the output buffer to the handle.
+   */
+  void flush() {
+    write_out(buffer.data(), buffer.size());
+    buffer.clear();
+  }
+
+  /**
+   * @brief Writes a buffer to the output handle, recording any failure.
+   */
+  void write_out(const char *data, size_t size) {
+    while (size > 0 && !failed) {
+      DWORD chunk = (size > 0x40000000) ? 0x40000000 : (DWORD)size;
+      DWORD written = 0;
+      if (!WriteFile(out, data, chunk, &written, NULL) || written == 0) {
+        failed = true;
+        break;
+      }
+      data += written;
+      size -= written;
+    }
+  }
+
+  HANDLE out;
+  bool owns_handle;
+  bool failed;
+  std::string buffer;
+  std::mutex mutex;
+  std::unordered_map<std::string, bool> members; /**< Emitted members, true for directories. */
+};
+
+const char tar_filesystem::zero_block[tar_filesystem::BLOCK_SIZE] = {};
+
+/**
+ * @brief A change recorded in an undo journal.
+ *
+ * In the journal file a record is stored as its kind, the backup number (for overwrites
+ * only) as a 32-bit little-endian integer, the path length as a 16-bit little-endian
+ * integer and the path itself.
+ */
+struct journal_record {
+  char kind;        /**< 'C' for a created file, 'O' for an overwritten file, 'D' for a created directory. */
+  unsigned backup;  /**< For 'O', the name of the original file in the side area. */
+  std::string path;
+};
+
+/**
+ * @brief The first bytes of every journal file.
+ */
+const char journal_magic[8] = {'T', 'O', 'U', 'C', 'H', 'J', '1', '\n'};
+
+/**
+ * @brief Appends the binary form of a journal record to a buffer.
+ */
+void encode_journal_record(const journal_record &record, std::string *out) {
+  out->push_back(record.kind);
+  if (record.kind == 'O') {
+    for (int shift = 0; shift < 32; shift += 8) {
+      out->push_back((char)((record.backup >> shift) & 0xFF));
+    }
+  }
+  size_t length = std::min<size_t>(record.path.size(), 0xFFFF);
+  out->push_back((char)(length & 0xFF));
+  out->push_back((char)(length >> 8));
+  out->append(record.path, 0, length);
+}
+
+/**
+ * @brief Reads the records of a journal file.
+ *
+ * A record cut short at the end of the file, which happens if touch was killed while the
+ * journal was written, is ignored.
+ *
+ * @param path The journal file.
+ * @param records The vector to append the records to.
+ * @return True if the file is a journal.
+ */
+bool read_journal(const std::string &path, std::vector<journal_record> *records) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) return false;
+  std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  if (data.size() < sizeof(journal_magic) || memcmp(data.data(), journal_magic, sizeof(journal_magic)) != 0) {
+    return false;
+  }
+  size_t pos = sizeof(journal_magic);
+  while (pos < data.size()) {
+    journal_record record = {data[pos], 0, std::string()};
+    size_t header = (record.kind == 'O') ? 7 : 3;
+    if (record.kind != 'C' && record.kind != 'O' && record.kind != 'D') return false;
+    if (data.size() - pos < header) break;
+    const unsigned char *bytes = (const unsigned char *)data.data() + pos + 1;
+    if (record.kind == 'O') {
+      record.backup = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned)bytes[3] << 24);
+      bytes += 4;
+    }
+    size_t length = bytes[0] | (bytes[1] << 8);
+    if (data.size() - pos - header < length) break;
+    record.path.assign(data, pos + header, length);
+    records->push_back(record);
+    pos += header + length;
+  }
+  return true;
+}
+
+/**
+ * @brief Undoes the changes recorded in an undo journal.
+ *
+ * Files are independent of each other, so they are restored by several threads in
+ * parallel. Directories are removed afterwards, newest first so children go before their
+ * parents. A change that was never made, or was already undone by an earlier rollback,
+ * counts as undone.
+ *
+ * @param fs The filesystem backend the changes were made with.
+ * @param records The journal records in the order they were written.
+ * @param side_path The side area holding the originals of overwritten files.
+ * @return The number of changes that could not be undone.
+ */
+size_t rollback_journal(filesystem &fs, const std::vector<journal_record> &records, const std::string &side_path) {
+  // Only the first change of a path matters: undoing it restores the state before the
+  // transaction, whatever happened to the path later.
+  std::unordered_map<std::string, size_t> first_change;
+  for (size_t i = 0; i < records.size(); i++) {
+    if (records[i].kind == 'D') continue;
+    std::string key = records[i].path;
+    for (char &c : key) {
+      if (c == '/') c = '\\';
+    }
+    while (key.compare(0, 2, ".\\") == 0) key.erase(0, 2);
+    first_change.emplace(key, i);
+  }
+  std::vector<size_t> files;
+  files.reserve(first_change.size());
+  for (const auto &entry : first_change) {
+    files.push_back(entry.second);
+  }
+
+  std::atomic<size_t> next(0);
+  std::atomic<size_t> failures(0);
+  auto restore_files = [&]() {
+    for (size_t i = next++; i < files.size(); i = next++) {
+      const journal_record &record = records[files[i]];
+      file_stat existing;
+      bool ok;
+      if (record.kind == 'C') {
+        ok = fs.remove(record.path) || !fs.stat(record.path, &existing);
+      }
+      else {
+        std::string backup = join_path(side_path, std::to_string(record.backup));
+        ok = fs.rename(backup, record.path) || !fs.stat(backup, &existing);
+      }
+      if (!ok) {
+        ERROR_PRINT("Error: Could not roll back %s\n", record.path.c_str());
+        failures++;
+      }
+    }
+  };
+  unsigned thread_count = (unsigned)std::min<size_t>(files.size(), ROLLBACK_THREADS);
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < thread_count; i++) {
+    threads.emplace_back(restore_files);
+  }
+  restore_files();
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  for (size_t i = records.size(); i-- > 0;) {
+    file_stat existing;
+    if (records[i].kind == 'D' && !fs.rmdir(records[i].path) && fs.stat(records[i].path, &existing)) {
+      ERROR_PRINT("Error: Could not roll back directory %s\n", records[i].path.c_str());
+      failures++;
+    }
+  }
+
+  // Originals of files that were overwritten more than once are not needed any more.
+  if (failures.load() == 0) {
+    for (const journal_record &record : records) {
+      if (record.kind == 'O') fs.remove(join_path(side_path, std::to_string(record.backup)));
+    }
+    fs.rmdir(side_path);
+  }
+  return failures.load();
+}
+
+/**
+ * @brief Filesystem decorator that records every change in an undo journal, so a failed
+ * batch can be rolled back.
+ *
+ * A record is added before its change is made, so the records may name a file or
+ * directory that was never created but do not miss one that was; rolling back skips what
+ * doesn't exist. Records of created files and directories are gathered in memory and
+ * written in blocks of JOURNAL_FLUSH_SIZE bytes, which makes journaling cost a buffer
+ * append per file instead of a write. A rollback in the same process works from the
+ * records in memory and sees every change. --rollback after touch was killed only sees
+ * the blocks written up to that point, so it can miss the files and directories of the
+ * last unwritten block, up to JOURNAL_FLUSH_SIZE bytes of records.
+ *
+ * Overwrites are different: the original is moved into the side area (the journal path
+ * with ".d" appended), a rename rather than a copy, and its record is written out first
+ * so the original can always be found again.
+ *
+ * The journal file is written through the wrapped filesystem, which has to consume
+ * written data immediately; the tar backend, which does not, can't be journaled.
+ *
+ * Overwrites are detected from stat(): touch always checks whether a file exists before
+ * creating it, and only the main thread overwrites files, after asking the user.
+ * create_at() is used by the batch workers for files their stat() didn't find, so it
+ * checks again itself and saves a file that appeared in the meantime.
+ */
+class journaled_filesystem : public filesystem {
+public:
+  journaled_filesystem(filesystem &inner, const std::string &journal_path)
+    : inner(inner), journal_path(journal_path), side_path(journal_path + ".d"),
+      journal(nullptr), side_created(false), next_backup(0), appended(0), committed(0),
+      flushing(false), failed(false) {}
+
+  /**
+   * @brief Creates the journal file.
+   * @return False if the journal already exists or can't be written.
+   */
+  bool begin() {
+    file_stat existing;
+    if (inner.stat(journal_path, &existing) || inner.stat(side_path, &existing)) {
+      ERROR_PRINT("Error: The journal %s of an unfinished transaction exists, roll it back with --rollback=%s\n",
+                  journal_path.c_str(), journal_path.c_str());
+      return false;
+    }
+    journal = inner.create(journal_path);
+    if (journal == nullptr) {
+      ERROR_PRINT("Error: Could not create journal %s\n", journal_path.c_str());
+      return false;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    buffer.assign(journal_magic, sizeof(journal_magic));
+    return flush_journal(lock, ++appended);
+  }
+
+  /**
+   * @brief Makes the changes permanent: deletes the saved originals and the journal.
+   * @return True if the journal was removed.
+   */
+  bool commit() {
+    std::unique_lock<std::mutex> lock(mutex);
+    close_journal(lock);
+    for (const journal_record &record : records) {
+      if (record.kind == 'O') inner.remove(join_path(side_path, std::to_string(record.backup)));
+    }
+    if (side_created) inner.rmdir(side_path);
+    return inner.remove(journal_path);
+  }
+
+  /**
+   * @brief Undoes every change made through this filesystem.
+   *
+   * The journal is removed if everything could be undone, otherwise it is kept so the
+   * rollback can be completed later with --rollback.
+   *
+   * @return The number of changes that could not be undone.
+   */
+  size_t rollback() {
+    std::unique_lock<std::mutex> lock(mutex);
+    close_journal(lock);
+    size_t failures = rollback_journal(inner, records, side_path);
+    if (failures == 0) {
+      inner.remove(journal_path);
+    }
+    return failures;
+  }
+
+  /**
+   * @brief The number of changes recorded so far.
+   */
+  size_t change_count() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return records.size();
+  }
+
+  fs_handle create(const std::string &path) override {
+    bool overwrite;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      overwrite = existing.erase(path) != 0;
+    }
+    if (overwrite ? !save_original(path) : !record('C', path)) {
+      return nullptr;
+    }
+    return inner.create(path);
+  }
+
+  bool write(fs_handle file, const char *data, size_t size) override {
+    return inner.write(file, data, size);
+  }
+
+  bool write_transient(fs_handle file, const char *data, size_t size) override {
+    return inner.write_transient(file, data, size);
+  }
+
+  bool extend(fs_handle file, unsigned long long size, bool sparse) override {
+    return inner.extend(file, size, sparse);
+  }
+
+  bool close(fs_handle file) override {
+    return inner.close(file);
+  }
+
+  bool stat(const std::string &path, file_stat *out) override {
+    if (!inner.stat(path, out)) return false;
+    if (!out->is_directory) {
+      std::lock_guard<std::mutex> lock(mutex);
+      existing.insert(path);
+    }
+    return true;
+  }
+
+  bool utimes(const std::string &path, time_t mtime) override {
+    return inner.utimes(path, mtime);
+  }
+
+  bool mkdir(const std::string &path) override {
+    return record('D', path) && inner.mkdir(path);
+  }
+
+  bool remove(const std::string &path) override {
+    // Deletions can't be undone, touch never makes them as part of a batch.
+    (void)path;
+    return false;
+  }
+
+  bool rmdir(const std::string &path) override {
+    (void)path;
+    return false;
+  }
+
+  bool rename(const std::string &from, const std::string &to) override {
+    (void)from;
+    (void)to;
+    return false;
+  }
+
+  fs_handle open_dir(const std::string &path) override {
+    fs_handle directory = inner.open_dir(path);
+    return (directory == nullptr) ? nullptr : new journal_dir{path, directory};
+  }
+
+  fs_handle create_at(fs_handle directory, const std::string &name) override {
+    journal_dir *dir = static_cast<journal_dir *>(directory);
+    std::string path = join_path(dir->path, name);
+    // The batch workers only get here for files their stat() didn't find, so a file
+    // that exists now appeared since then; it is saved like any other overwrite.
+    file_stat current;
+    bool overwrite = inner.stat(path, &current) && !current.is_directory;
+    if (overwrite ? !save_original(path) : !record('C', path)) return nullptr;
+    return inner.create_at(dir->handle, name);
+  }
+
+  void close_dir(fs_handle directory) override {
+    journal_dir *dir = static_cast<journal_dir *>(directory);
+    inner.close_dir(dir->handle);
+    delete dir;
+  }
+
+  // The asynchronous path only creates files that don't exist yet, so stat_async() does
+  // not need to track existing files.
+
+  void stat_async(io_executor &executor, const std::string &path, fs_request *request) override {
+    inner.stat_async(executor, path, request);
+  }
+
+  void create_async(io_executor &executor, const std::string &path, fs_request *request) override {
+    if (!record('C', path)) {
+      request->ok = false;
+      executor.post(request);
+      return;
+    }
+    inner.create_async(executor, path, request);
+  }
+
+  void write_async(io_executor &executor, fs_handle file, const char *data, size_t size,
+                   fs_request *request) override {
+    inner.write_async(executor, file, data, size, request);
+  }
+
+  void close_async(io_executor &executor, fs_handle file, fs_request *request) override {
+    inner.close_async(executor, file, request);
+  }
+
+private:
+  /**
+   * @brief A directory opened through the journal, remembering its path for the records.
+   */
+  struct journal_dir {
+    std::string path;
+    fs_handle handle; /**< The directory handle of the inner filesystem. */
+  };
+
+  /**
+   * @brief Adds a record for a created file or directory to the journal.
+   * @return False if the journal could not be written.
+   */
+  bool record(char kind, const std::string &path) {
+    std::unique_lock<std::mutex> lock(mutex);
+    records.push_back({kind, 0, path});
+    encode_journal_record(records.back(), &buffer);
+    appended++;
+    return (buffer.size() < JOURNAL_FLUSH_SIZE && !failed) || flush_journal(lock, appended);
+  }
+
+  /**
+   * @brief Moves the original of a file about to be overwritten into the side area.
+   * @return True if the original is saved and recorded.
+   */
+  bool save_original(const std::string &path) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!side_created) {
+      side_created = inner.mkdir(side_path);
+      if (!side_created) {
+        ERROR_PRINT("Error: Could not create the journal directory %s\n", side_path.c_str());
+        return false;
+      }
+    }
+    journal_record original = {'O', next_backup++, path};
+    records.push_back(original);
+    encode_journal_record(original, &buffer);
+    if (!flush_journal(lock, ++appended) ||
+        !inner.rename(path, join_path(side_path, std::to_string(original.backup)))) {
+      ERROR_PRINT("Error: Could not save the original of %s\n", path.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Waits until the journal holds every record up to a sequence number.
+   *
+   * If no other thread is writing the journal, the caller writes everything gathered so
+   * far; otherwise it waits for that thread and writes what was gathered in the meantime.
+   *
+   * @param lock The caller's lock on mutex, released while the journal is written.
+   * @param sequence The sequence number of the caller's last record.
+   * @return False if the journal could not be written.
+   */
+  bool flush_journal(std::unique_lock<std::mutex> &lock, unsigned long long sequence) {
+    while (committed < sequence && !failed) {
+      if (flushing) {
+        flushed.wait(lock);
+        continue;
+      }
+      flushing = true;
+      std::string block;
+      block.swap(buffer);
+      unsigned long long target = appended;
+      lock.unlock();
+      bool ok = journal != nullptr && inner.write(journal, block.data(), block.size());
+      lock.lock();
+      flushing = false;
+      committed = target;
+      failed = !ok;
+      flushed.notify_all();
+    }
+    if (failed) {
+      ERROR_PRINT("Error: Could not write journal %s\n", journal_path.c_str());
+    }
+    return !failed;
+  }
+
+  /**
+   * @brief Waits for pending journal writes and closes the journal file.
+   */
+  void close_journal(std::unique_lock<std::mutex> &lock) {
+    flushed.wait(lock, [&] { return !flushing; });
+    if (journal != nullptr && !inner.close(journal)) {
+      ERROR_PRINT("Error: Could not write journal %s\n", journal_path.c_str());
+    }
+    journal = nullptr;
+  }
+
+  filesystem &inner;
+  std::string journal_path;
+  std::string side_path;
+  fs_handle journal;
+  bool side_created;
+  unsigned next_backup;
+  unsigned long long appended;              /**< Sequence number of the last record added. */
+  unsigned long long committed;             /**< Sequence number of the last record written. */
+  bool flushing;                            /**< True while a thread writes the journal. */
+  bool failed;                              /**< True once a journal write has failed. */
+  std::mutex mutex;
+  std::condition_variable flushed;
+  std::string buffer;                       /**< Records not yet written to the journal. */
+  std::vector<journal_record> records;      /**< Every record, for an in-process rollback. */
+  std::unordered_set<std::string> existing; /**< Files stat() found, which create() overwrites. */
+};
+
+/**
+ * @brief Incremental SHA-256 (FIPS 180-4).
+ */
+class sha256 {
+public:
+  sha256() : length(0), used(0) {
+    static const uint32_t initial[8] = {
+      0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    memcpy(state, initial, sizeof(state));
+  }
+
+  void update(const char *data, size_t size) {
+    const unsigned char *next = (const unsigned char *)data;
+    length += size;
+    if (used > 0) {
+      size_t take = std::min(size, sizeof(block) - used);
+      memcpy(block + used, next, take);
+      used += take;
+      next += take;
+      size -= take;
+      if (used < sizeof(block)) return;
+      transform(block);
+      used = 0;
+    }
+    // Whole blocks are hashed straight from the input, without copying.
+    for (; size >= sizeof(block); next += sizeof(block), size -= sizeof(block)) {
+      transform(next);
+    }
+    memcpy(block, next, size);
+    used = size;
+  }
+
+  /**
+   * @brief Completes the hash.
+   * @return The digest as 64 lowercase hex digits.
+   */
+  std::string finish() {
+    unsigned long long bits = length * 8;
+    unsigned char padding[sizeof(block) + 8] = {0x80};
+    size_t pad = (used < 56) ? 56 - used : 120 - used;
+    for (int i = 0; i < 8; i++) {
+      padding[pad + i] = (unsigned char)(bits >> (56 - 8 * i));
+    }
+    update((const char *)padding, pad + 8);
+    static const char hex[] = "0123456789abcdef";
+    std::string digest(64, '0');
+    for (int i = 0; i < 32; i++) {
+      unsigned char byte = (unsigned char)(state[i / 4] >> (24 - 8 * (i % 4)));
+      digest[2 * i] = hex[byte >> 4];
+      digest[2 * i + 1] = hex[byte & 15];
+    }
+    return digest;
+  }
+
+private:
+  static uint32_t rotate(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+  }
+
+  void transform(const unsigned char *data) {
+    static const uint32_t k[64] = {
+      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+      0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+      0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+      0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+      0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+      0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+      w[i] = ((uint32_t)data[4 * i] << 24) | ((uint32_t)data[4 * i + 1] << 16) |
+             ((uint32_t)data[4 * i + 2] << 8) | data[4 * i + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+      uint32_t s0 = rotate(w[i - 15], 7) ^ rotate(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      uint32_t s1 = rotate(w[i - 2], 17) ^ rotate(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++) {
+      uint32_t t1 = h + (rotate(e, 6) ^ rotate(e, 11) ^ rotate(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+      uint32_t t2 = (rotate(a, 2) ^ rotate(a, 13) ^ rotate(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+      h = g; g = f; f = e; e = d + t1;
+      d = c; c = b; b = a; a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+  }
+
+  uint32_t state[8];
+  unsigned long long length; /**< Bytes hashed so far. */
+  unsigned char block[64];   /**< The partial block not yet transformed. */
+  size_t used;               /**< Bytes in block. */
+};
+
+/**
+ * @brief Filesystem decorator that records a SHA-256 checksum of every file written.
+ *
+ * The checksum is computed from the buffers handed to write(), on the thread that creates
+ * the file, right before the file is closed; the buffers are still valid then, so nothing
+ * is copied or read back from disk, and the hashing of one file overlaps with the I/O of
+ * the files other workers are writing. Many files of a batch render to the same content
+ * (e.g. every file type without a template is empty), so the checksums of small contents
+ * are remembered and identical files are only hashed once.
+ *
+ * Workers hand the finished lines to a single writer thread, which appends them to the
+ * manifest in the format of sha256sum, in the order the files were completed.
+ */
+class manifest_filesystem : public filesystem {
+public:
+  /**
+   * @param inner The filesystem the files are created on.
+   * @param out The manifest file, or the stdout handle.
+   * @param owned True to close out when the manifest is finished.
+   */
+  manifest_filesystem(filesystem &inner, HANDLE out, bool owned)
+    : inner(inner), out(out), owned(owned), done(false), failed(false) {
+    writer = std::thread([this]() { write_lines(); });
+  }
+
+  ~manifest_filesystem() {
+    finish();
+  }
+
+  /**
+   * @brief Writes the remaining lines and closes the manifest.
+   * @return True if every line was written.
+   */
+  bool finish() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (done) return !failed;
+      done = true;
+    }
+    pending.notify_one();
+    writer.join();
+    if (owned) CloseHandle(out);
+    return !failed;
+  }
+
+  fs_handle create(const std::string &path) override {
+    return wrap(inner.create(path), path);
+  }
+
+  bool write(fs_handle file, const char *data, size_t size) override {
+    manifest_file *entry = static_cast<manifest_file *>(file);
+    if (!inner.write(entry->handle, data, size)) return false;
+    if (entry->streaming) {
+      entry->hash.update(data, size);
+    }
+    else {
+      entry->chunks.emplace_back(data, size);
+    }
+    return true;
+  }
+
+  bool write_transient(fs_handle file, const char *data, size_t size) override {
+    manifest_file *entry = static_cast<manifest_file *>(file);
+    start_streaming(*entry);
+    entry->hash.update(data, size);
+    return inner.write_transient(entry->handle, data, size);
+  }
+
+  bool extend(fs_handle file, unsigned long long size, bool sparse) override {
+    manifest_file *entry = static_cast<manifest_file *>(file);
+    start_streaming(*entry);
+    for (unsigned long long left = size; left > 0;) {
+      size_t chunk = (size_t)std::min<unsigned long long>(left, FILL_BLOCK_SIZE);
+      entry->hash.update(zero_fill_block(), chunk);
+      left -= chunk;
+    }
+    return inner.extend(entry->handle, size, sparse);
+  }
+
+  bool close(fs_handle file) override {
+    manifest_file *entry = static_cast<manifest_file *>(file);
+    std::string digest = checksum(*entry);
+    bool ok = inner.close(entry->handle);
+    if (ok) add_line(digest, entry->path);
+    delete entry;
+    return ok;
+  }
+
+  bool stat(const std::string &path, file_stat *out) override {
+    return inner.stat(path, out);
+  }
+
+  bool utimes(const std::string &path, time_t mtime) override {
+    return inner.utimes(path, mtime);
+  }
+
+  bool mkdir(const std::string &path) override {
+    return inner.mkdir(path);
+  }
+
+  bool remove(const std::string &path) override {
+    return inner.remove(path);
+  }
+
+  bool rmdir(const std::string &path) override {
+    return inner.rmdir(path);
+  }
+
+  bool rename(const std::string &from, const std::string &to) override {
+    return inner.rename(from, to);
+  }
+
+  fs_handle open_dir(const std::string &path) override {
+    fs_handle directory = inner.open_dir(path);
+    return (directory == nullptr) ? nullptr : new manifest_dir{path, directory};
+  }
+
+  fs_handle create_at(fs_handle directory, const std::string &name) override {
+    manifest_dir *dir = static_cast<manifest_dir *>(directory);
+    return wrap(inner.create_at(dir->handle, name), join_path(dir->path, name));
+  }
+
+  void close_dir(fs_handle directory) override {
+    manifest_dir *dir = static_cast<manifest_dir *>(directory);
+    inner.close_dir(dir->handle);
+    delete dir;
+  }
+
+  void stat_async(io_executor &executor, const std::string &path, fs_request *request) override {
+    inner.stat_async(executor, path, request);
+  }
+
+  void create_async(io_executor &executor, const std::string &path, fs_request *request) override {
+    manifest_file *entry = new manifest_file;
+    entry->handle = nullptr;
+    entry->path = path;
+    inner.create_async(executor, path, new manifest_request(this, request, entry));
+  }
+
+  void write_async(io_executor &executor, fs_handle file, const char *data, size_t size,
+                   fs_request *request) override {
+    manifest_file *entry = static_cast<manifest_file *>(file);
+    entry->chunks.emplace_back(data, size);
+    inner.write_async(executor, entry->handle, data, size, request);
+  }
+
+  void close_async(io_executor &executor, fs_handle file, fs_request *request) override {
+    manifest_file *entry = static_cast<manifest_file *>(file);
+    // Hashed before the close is issued, while the buffers are known to be valid.
+    entry->digest = checksum(*entry);
+    inner.close_async(executor, entry->handle, new manifest_request(this, request, entry));
+  }
+
+private:
+  /**
+   * @brief A file being written, with the buffers it was written from.
+   */
+  struct manifest_file {
+    fs_handle handle; /**< The file handle of the inner filesystem. */
+    std::string path;
+    std::vector<std::pair<const char *, size_t>> chunks;
+    std::string digest;     /**< Set before an asynchronous close. */
+    bool streaming = false; /**< True once hashed as written, see start_streaming(). */
+    sha256 hash;
+  };
+
+  /**
+   * @brief A directory opened through the manifest, remembering its path for the lines.
+   */
+  struct manifest_dir {
+    std::string path;
+    fs_handle handle; /**< The directory handle of the inner filesystem. */
+  };
+
+  /**
+   * @brief Completes an asynchronous create or close of the inner filesystem and then the
+   * caller's request: a create wraps the new handle, a close records the file's line.
+   */
+  struct manifest_request : fs_request {
+    manifest_request(manifest_filesystem *owner, fs_request *outer, manifest_file *entry)
+      : owner(owner), outer(outer), entry(entry) {}
+
+    void complete() override {
+      bool closing = entry->handle != nullptr;
+      if (closing) {
+        if (ok) owner->add_line(entry->digest, entry->path);
+        delete entry;
+      }
+      else if (ok) {
+        entry->handle = handle;
+        outer->handle = entry;
+      }
+      else {
+        delete entry;
+        outer->handle = nullptr;
+      }
+      outer->ok = ok;
+      fs_request *caller = outer;
+      delete this;
+      caller->complete();
+    }
+
+    manifest_filesystem *owner;
+    fs_request *outer;
+    manifest_file *entry;
+  };
+
+  fs_handle wrap(fs_handle file, const std::string &path) {
+    if (file == nullptr) return nullptr;
+    manifest_file *entry = new manifest_file;
+    entry->handle = file;
+    entry->path = path;
+    return entry;
+  }
+
+  /**
+   * @brief Hashes the buffers written so far and everything written later right away,
+   * for files with content that isn't kept until the close, e.g. a --size payload.
+   */
+  void start_streaming(manifest_file &entry) {
+    if (entry.streaming) return;
+    for (const auto &chunk : entry.chunks) entry.hash.update(chunk.first, chunk.second);
+    entry.chunks.clear();
+    entry.streaming = true;
+  }
+
+  /**
+   * @brief Computes the checksum of a file from the buffers written to it.
+   */
+  std::string checksum(manifest_file &entry) {
+    if (entry.streaming) return entry.hash.finish();
+    size_t size = 0;
+    for (const auto &chunk : entry.chunks) size += chunk.second;
+    std::string content;
+    if (entry.chunks.size() <= 1 && size <= MANIFEST_MEMO_SIZE) {
+      if (size > 0) content.assign(entry.chunks[0].first, size);
+      std::lock_guard<std::mutex> lock(memo_mutex);
+      auto found = memo.find(content);
+      if (found != memo.end()) return found->second;
+    }
+    sha256 hash;
+    for (const auto &chunk : entry.chunks) hash.update(chunk.first, chunk.second);
+    std::string digest = hash.finish();
+    if (size <= MANIFEST_MEMO_SIZE && entry.chunks.size() <= 1) {
+      std::lock_guard<std::mutex> lock(memo_mutex);
+      if (memo.size() < MANIFEST_MEMO_ENTRIES) memo.emplace(std::move(content), digest);
+    }
+    return digest;
+  }
+
+  /**
+   * @brief Queues the manifest line of a file for the writer thread.
+   *
+   * Paths are written with forward slashes, which every sha256sum accepts, no matter how
+   * the batch spelled them.
+   */
+  void add_line(const std::string &digest, const std::string &path) {
+    std::string line = digest + "  " + path + "\n";
+    std::replace(line.begin() + 66, line.end(), '\\', '/');
+    bool wake;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      wake = lines.empty();
+      lines += line;
+    }
+    if (wake) pending.notify_one();
+  }
+
+  /**
+   * @brief The writer thread: writes whatever lines were queued while it was writing.
+   */
+  void write_lines() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+      pending.wait(lock, [&] { return done || !lines.empty(); });
+      if (lines.empty()) break;
+      std::string block;
+      block.swap(lines);
+      lock.unlock();
+      bool ok = write_all(out, block.data(), block.size());
+      lock.lock();
+      if (!ok) failed = true;
+    }
+  }
+
+  filesystem &inner;
+  HANDLE out;
+  bool owned;
+  bool done;     /**< True once finish() was called. */
+  bool failed;   /**< True once a write to the manifest has failed. */
+  std::mutex mutex;
+  std::condition_variable pending;
+  std::string lines; /**< Lines not yet written to the manifest. */
+  std::thread writer;
+  std::mutex memo_mutex;
+  std::unordered_map<std::string, std::string> memo; /**< Checksums of small contents. */
+};
+
+/**
+ * @brief Converts an option identifier to its final output form.
+ *
+ * Special option identifiers (such as "<date>" and "<file>") are replaced with their
+ * corresponding values. If an option exists in the variable map, that value is returned.
+ * Otherwise, the original option is returned.
+ *
+ * @param option The option identifier to convert.
+ * @param filename The filename used for substituting the "<file>" option.
+ * @return A string containing the converted option.
+ */
+std::string convert_option(const std::string &option, const std::string &filename) {
+  if (option == "<date>") {
+    return "DATE: " + get_current_date();
+  }
+  else if (option == "<file>") {
+    return "FILE: " + filename;
+  }
+  else {
+    if (variable_map.find(option) != variable_map.end()) {
+      return variable_map.at(option);
+    }
+    else {
+      return option;
+    }
+  }
+}
+
+/**
+ * @brief Decompresses a buffer in the LZ4 block format.
+ *
+ * Every length and offset is checked, so a damaged buffer is rejected instead of being
+ * read or written out of bounds.
+ *
+ * @param in The compressed data.
+ * @param in_size The size of the compressed data.
+ * @param out The buffer for the decompressed data.
+ * @param out_size The exact size of the decompressed data.
+ * @return True if the data was decompressed to exactly out_size bytes.
+ */
+bool lz4_decompress(const unsigned char *in, size_t in_size, char *out, size_t out_size) {
+  size_t ip = 0;
+  size_t op = 0;
+  // A length of 15 in the token continues in the following bytes, up to a byte below 255.
+  auto read_length = [&](size_t length, size_t *result) {
+    if (length == 15) {
+      unsigned char byte;
+      do {
+        if (ip >= in_size) return false;
+        byte = in[ip++];
+        length += byte;
+      } while (byte == 255);
+    }
+    *result = length;
+    return true;
+  };
+  while (ip < in_size) {
+    unsigned char token = in[ip++];
+    size_t literals;
+    if (!read_length(token >> 4, &literals) || literals > in_size - ip || literals > out_size - op) return false;
+    memcpy(out + op, in + ip, literals);
+    ip += literals;
+    op += literals;
+    if (ip == in_size) break; // The last sequence has no match.
+    if (in_size - ip < 2) return false;
+    size_t offset = in[ip] | ((size_t)in[ip + 1] << 8);
+    ip += 2;
+    size_t match;
+    if (offset == 0 || offset > op || !read_length(token & 15, &match)) return false;
+    match += 4;
+    if (match > out_size - op) return false;
+    // Matches may overlap the output they produce, so they are copied byte by byte.
+    for (size_t i = 0; i < match; i++, op++) {
+      out[op] = out[op - offset];
+    }
+  }
+  return op == out_size;
+}
+
+/**
+ * @brief Returns the text of a bundled license.
+ *
+ * The texts are decompressed on the first call, once per run, so a configuration
+ * without licenses never pays for them.
+ *
+ * @param id The SPDX identifier, matched without regard to case.
+ * @param canonical_id If not null, receives the identifier as SPDX spells it.
+ * @param text Receives the text: paragraphs separated by blank lines, one line each.
+ * @return False if there is no license with this identifier.
+ */
+bool find_license(const std::string &id, std::string *canonical_id, std::string *text) {
+  static const std::string texts = []() {
+    std::string decompressed(spdx_licenses::text_size, '\0');
+    if (!lz4_decompress(spdx_licenses::compressed, spdx_licenses::compressed_size, &decompressed[0], decompressed.size())) {
+      ERROR_PRINT("Error: The bundled license texts are damaged\n");
+      decompressed.clear();
+    }
+    return decompressed;
+  }();
+  for (size_t i = 0; i < spdx_licenses::license_count; i++) {
+    const spdx_licenses::license_entry &entry = spdx_licenses::licenses[i];
+    if (strlen(entry.id) != id.size() || _strnicmp(entry.id, id.data(), id.size()) != 0) continue;
+    if (entry.offset + entry.length > texts.size()) return false;
+    if (canonical_id != nullptr) *canonical_id = entry.id;
+    text->assign(texts, entry.offset, entry.length);
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Wraps text to a width.
+ *
+ * Paragraphs are separated by blank lines and are filled word by word; paragraphs that
+ * start with a space (e.g. an indented URL) are kept as they are.
+ *
+ * @param text The text to wrap.
+ * @param width The maximum length of a line, exceeded only by words longer than it.
+ * @return The lines, with empty lines between paragraphs.
+ */
+std::vector<std::string> reflow_text(const std::string &text, size_t width) {
+  std::vector<std::string> lines;
+  size_t start = 0;
+  while (start < text.size()) {
+    size_t end = text.find("\n\n", start);
+    if (end == std::string::npos) end = text.size();
+    std::string paragraph = text.substr(start, end - start);
+    start = text.find_first_not_of('\n', end);
+    if (start == std::string::npos) start = text.size();
+    if (paragraph.empty()) continue;
+    if (!lines.empty()) lines.push_back(std::string());
+    if (paragraph[0] == ' ') {
+      size_t line_start = 0;
+      while (line_start <= paragraph.size()) {
+        size_t line_end = paragraph.find('\n', line_start);
+        if (line_end == std::string::npos) line_end = paragraph.size();
+        lines.push_back(paragraph.substr(line_start, line_end - line_start));
+        line_start = line_end + 1;
+      }
+      continue;
+    }
+    std::string line;
+    size_t word_start = paragraph.find_first_not_of(" \n");
+    while (word_start != std::string::npos) {
+      size_t word_end = paragraph.find_first_of(" \n", word_start);
+      if (word_end == std::string::npos) word_end = paragraph.size();
+      if (!line.empty() && line.size() + 1 + (word_end - word_start) > width) {
+        lines.push_back(line);
+        line.clear();
+      }
+      if (!line.empty()) line += ' ';
+      line.append(paragraph, word_start, word_end - word_start);
+      word_start = paragraph.find_first_not_of(" \n", word_end);
+    }
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+/**
+ * @brief Kinds of the segments a render plan is made of.
+ */
+enum segment_kind {
+  SEGMENT_LITERAL = 0, /**< Text copied as is. */
+  SEGMENT_FILE = 1,    /**< The name of the file being created. */
+  SEGMENT_DATE = 2,    /**< The current date. */
+  SEGMENT_SEQ = 3,     /**< The file's sequence number; the text is the first number, e.g. "0001". */
+  SEGMENT_UUID = 4,    /**< A UUID for the file; the text is "v4", "v7" or empty for v4. */
+  SEGMENT_PLUGIN = 5,  /**< A placeholder of a plugin; the text is "LIBRARY|NAME" or "LIBRARY|NAME:ARG". */
+  SEGMENT_OWNER = 6,   /**< The owners of the file according to the CODEOWNERS of its repository. */
+};
+
+/**
+ * @brief Hands out the numbers of <seq> placeholders, unique within a run.
+ *
+ * Every thread takes a block of consecutive numbers from a shared atomic and numbers its
+ * files from it, so threads never contend per file. Blocks start at one number and
+ * double up to SEQUENCE_BLOCK, which keeps the numbers of small batches contiguous.
+ * Within a thread the numbers increase; across threads of a parallel batch they are
+ * unique but may leave gaps.
+ *
+ * With a counter file numbering continues across runs. The file is locked once, when it
+ * is opened, and holds the next number; finish() writes it back.
+ */
+class sequence_counter {
+public:
+  sequence_counter() : next_block(1), first(1), file(INVALID_HANDLE_VALUE) {}
+
+  /**
+   * @brief Opens and locks the counter file and continues numbering from it.
+   *
+   * A missing or empty file starts at 1. Other runs using the same file wait for up to
+   * SEQUENCE_LOCK_TIMEOUT milliseconds until this one has finished.
+   *
+   * @param path The counter file.
+   * @return True if the file was opened and holds a valid number.
+   */
+  bool open(const std::string &path) {
+    ULONGLONG deadline = GetTickCount64() + SEQUENCE_LOCK_TIMEOUT;
+    while (true) {
+      file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+      if (file != INVALID_HANDLE_VALUE || GetLastError() != ERROR_SHARING_VIOLATION || GetTickCount64() >= deadline) break;
+      Sleep(1);
+    }
+    if (file == INVALID_HANDLE_VALUE) {
+      ERROR_PRINT("Error: Could not open counter file %s\n", path.c_str());
+      return false;
+    }
+    char buffer[32] = {};
+    DWORD read = 0;
+    if (!ReadFile(file, buffer, sizeof(buffer) - 1, &read, NULL)) read = 0;
+    buffer[read] = '\0';
+    char *end = buffer;
+    unsigned long long value = strtoull(buffer, &end, 10);
+    if (end == buffer) value = 1;
+    if (value == 0 || strspn(end, " \t\r\n") != strlen(end)) {
+      ERROR_PRINT("Error: Invalid counter file %s\n", path.c_str());
+      CloseHandle(file);
+      file = INVALID_HANDLE_VALUE;
+      return false;
+    }
+    first = value;
+    next_block.store(value);
+    return true;
+  }
+
+  /**
+   * @brief Returns the next number of the calling thread, starting at 1 (or the counter file).
+   */
+  unsigned long long next() {
+    block &local = thread_block();
+    if (local.next == local.end) {
+      local.size = (local.size == 0) ? 1 : std::min<unsigned long long>(local.size * 2, SEQUENCE_BLOCK);
+      local.next = next_block.fetch_add(local.size, std::memory_order_relaxed);
+      local.end = local.next + local.size;
+    }
+    local.last = local.next;
+    return local.next++;
+  }
+
+  /**
+   * @brief Saves the number after the highest one used to the counter file and unlocks it.
+   *
+   * Must only be called once no thread draws numbers anymore.
+   *
+   * @param keep False to leave the file as it was, e.g. because the run was rolled back.
+   * @return True if the counter file was written, or there is none.
+   */
+  bool finish(bool keep) {
+    if (file == INVALID_HANDLE_VALUE) return true;
+    unsigned long long next_number = first;
+    {
+      std::lock_guard<std::mutex> lock(blocks_mutex);
+      for (const auto &local : blocks) {
+        if (local->last >= next_number) next_number = local->last + 1;
+      }
+    }
+    bool ok = true;
+    if (keep && next_number != first) {
+      std::string text = std::to_string(next_number) + "\n";
+      LARGE_INTEGER zero = {};
+      ok = SetFilePointerEx(file, zero, NULL, FILE_BEGIN) && write_all(file, text.data(), text.size()) &&
+           SetEndOfFile(file);
+    }
+    CloseHandle(file);
+    file = INVALID_HANDLE_VALUE;
+    return ok;
+  }
+
+private:
+  /**
+   * @brief The block of numbers a thread draws from.
+   */
+  struct block {
+    unsigned long long next; /**< The next number to hand out. */
+    unsigned long long end;  /**< One past the last number of the block. */
+    unsigned long long size; /**< Size of the block, doubled on every refill. */
+    unsigned long long last; /**< The last number handed out, 0 if none. */
+  };
+
+  /**
+   * @brief The calling thread's block, registered on first use so finish() can see it.
+   *
+   * The block outlives its thread. There is a single counter per process, so a
+   * thread_local pointer is enough.
+   */
+  block &thread_block() {
+    static thread_local block *local = nullptr;
+    if (local == nullptr) {
+      std::lock_guard<std::mutex> lock(blocks_mutex);
+      blocks.emplace_back(new block());
+      local = blocks.back().get();
+    }
+    return *local;
+  }
+
+  std::atomic<unsigned long long> next_block; /**< The first number of the next block. */
+  unsigned long long first;                   /**< The number the run started at. */
+  std::mutex blocks_mutex;
+  std::vector<std::unique_ptr<block>> blocks;
+  HANDLE file;                                /**< The locked counter file, if any. */
+};
+
+/**
+ * @brief The numbers of the <seq> placeholders of this run.
+ */
+sequence_counter sequence;
+
+/**
+ * @brief Formats a new UUID of version 4 (random) or 7 (time-ordered).
+ *
+ * Every thread has its own xoshiro256** generator, so UUIDs are generated without any
+ * shared state. Version 7 UUIDs of a thread increase even within a millisecond: the 12
+ * bits after the timestamp count up from a random start. The generator is fast, not
+ * cryptographically secure; don't use the UUIDs as secrets.
+ *
+ * @param version 4 or 7.
+ * @return The UUID in its 36 character form, lower case.
+ */
+std::string generate_uuid(int version) {
+  static thread_local unsigned long long state[4] = {};
+  static thread_local unsigned long long last_ms = 0;
+  static thread_local unsigned counter = 0;
+  auto next = []() {
+    unsigned long long result = state[1] * 5;
+    result = ((result << 7) | (result >> 57)) * 9;
+    unsigned long long t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = (state[3] << 45) | (state[3] >> 19);
+    return result;
+  };
+  if ((state[0] | state[1] | state[2] | state[3]) == 0) {
+    // Seeded like random_fill: the clock, the process and a per-thread count.
+    static std::atomic<unsigned long long> generators(0);
+    LARGE_INTEGER clock;
+    QueryPerformanceCounter(&clock);
+    unsigned long long seed = (unsigned long long)clock.QuadPart ^ ((unsigned long long)GetCurrentProcessId() << 32) ^
+                              (++generators * 0x9e3779b97f4a7c15ULL);
+    for (unsigned long long &word : state) {
+      unsigned long long z = (seed += 0x9e3779b97f4a7c15ULL);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      word = z ^ (z >> 31);
+    }
+  }
+
+  unsigned char bytes[16];
+  unsigned long long high = next();
+  unsigned long long low = next();
+  if (version == 7) {
+    FILETIME now;
+    GetSystemTimeAsFileTime(&now);
+    unsigned long long ms = ((((unsigned long long)now.dwHighDateTime << 32) | now.dwLowDateTime) -
+                             116444736000000000ULL) / 10000;
+    if (ms > last_ms) {
+      last_ms = ms;
+      counter = (unsigned)(high & 0x7FF);
+    }
+    else if (++counter > 0xFFF) {
+      last_ms++;
+      counter = 0;
+    }
+    high = (last_ms << 16) | counter;
+  }
+  for (int i = 0; i < 8; i++) {
+    bytes[i] = (unsigned char)(high >> (56 - 8 * i));
+    bytes[8 + i] = (unsigned char)(low >> (56 - 8 * i));
+  }
+  bytes[6] = (unsigned char)((bytes[6] & 0x0F) | (version << 4));
+  bytes[8] = (unsigned char)((bytes[8] & 0x3F) | 0x80);
+
+  static const char digits[] = "0123456789abcdef";
+  std::string out;
+  out.reserve(36);
+  for (int i = 0; i < 16; i++) {
+    if (i == 4 || i == 6 || i == 8 || i == 10) out += '-';
+    out += digits[bytes[i] >> 4];
+    out += digits[bytes[i] & 0x0F];
+  }
+  return out;
+}
+
+/**
+ * @brief Placeholders provided by plugins, declared with PLUGIN lines in the configuration.
+ *
+ * Maps the name of a placeholder (e.g. "ticket" for <ticket>) to the DLL providing it.
+ */
+std::unordered_map<std::string, std::string> plugin_map;
+
+/**
+ * @brief The plugins of this run, loaded when a file first needs one of their placeholders.
+ *
+ * A configuration may declare plugins that the files of a run never use, so a DLL is only
+ * loaded, initialized and started (begin_run) once its first value is rendered. After
+ * that its providers are only read, and evaluated from any number of threads.
+ */
+class plugin_registry {
+public:
+  /**
+   * @brief Evaluates a plugin placeholder for a file, loading its plugin if needed.
+   *
+   * Failures are reported once per plugin and placeholder and render an empty value.
+   * Values must be single-line: a line break would end the comment the value is rendered
+   * in, so every run of CR and LF characters is replaced by a space.
+   *
+   * @param spec The text of a SEGMENT_PLUGIN: "LIBRARY|NAME" or "LIBRARY|NAME:ARG".
+   * @param path The file being created.
+   * @return The value.
+   */
+  std::string evaluate(const std::string &spec, const std::string &path) {
+    size_t bar = spec.find('|');
+    size_t colon = spec.find(':', bar);
+    std::string name = spec.substr(bar + 1, (colon == std::string::npos) ? std::string::npos : colon - bar - 1);
+    std::string argument = (colon == std::string::npos) ? std::string() : spec.substr(colon + 1);
+    library &plugin = load(spec.substr(0, bar));
+    auto found = plugin.providers.find(name);
+    if (found == plugin.providers.end()) {
+      if (!plugin.failed) report(plugin, "Error: Plugin " + plugin.path + " provides no placeholder <" + name + ">");
+      return std::string();
+    }
+    const provider_entry &entry = found->second;
+    char buffer[PLUGIN_VALUE_SIZE];
+    size_t length = sizeof(buffer);
+    if (entry.provider.evaluate(entry.state, path.c_str(), argument.c_str(), buffer, &length) != 0) {
+      report(plugin, "Error: Plugin " + plugin.path + " could not evaluate <" + name + "> for " + path);
+      return std::string();
+    }
+    if (length <= sizeof(buffer)) return single_line(std::string(buffer, length));
+    std::string value(length, '\0');
+    if (entry.provider.evaluate(entry.state, path.c_str(), argument.c_str(), &value[0], &length) != 0 ||
+        length > value.size()) {
+      report(plugin, "Error: Plugin " + plugin.path + " could not evaluate <" + name + "> for " + path);
+      return std::string();
+    }
+    value.resize(length);
+    return single_line(value);
+  }
+
+  /**
+   * @brief Ends the run of every loaded plugin (end_run) and unloads them.
+   *
+   * Must only be called once no thread renders anymore.
+   */
+  void finish() {
+    std::lock_guard<std::mutex> lock(libraries_mutex);
+    for (auto &loaded : libraries) {
+      library &plugin = *loaded.second;
+      for (auto &provider : plugin.providers) {
+        if (provider.second.provider.end_run != nullptr) provider.second.provider.end_run(provider.second.state);
+      }
+      plugin.providers.clear();
+      if (plugin.module != NULL) FreeLibrary(plugin.module);
+    }
+    libraries.clear();
+  }
+
+private:
+  /**
+   * @brief Replaces every run of line breaks in a value by a space.
+   */
+  static std::string single_line(std::string value) {
+    size_t out = 0;
+    bool in_break = false;
+    for (char c : value) {
+      bool line_break = c == '\r' || c == '\n';
+      if (!line_break || !in_break) {
+        value[out++] = line_break ? ' ' : c;
+      }
+      in_break = line_break;
+    }
+    value.resize(out);
+    return value;
+  }
+
+  /**
+   * @brief A registered provider and the state its begin_run returned.
+   */
+  struct provider_entry {
+    touch_provider provider;
+    void *state;
+  };
+
+  /**
+   * @brief A plugin DLL, loaded at most once.
+   */
+  struct library {
+    std::string path;
+    std::once_flag loaded;
+    HMODULE module = NULL;
+    bool failed = false; /**< True if the DLL could not be loaded or initialized. */
+    std::unordered_map<std::string, provider_entry> providers;
+    std::unordered_set<std::string> reported; /**< Errors already printed, guarded by libraries_mutex. */
+  };
+
+  /**
+   * @brief Returns a plugin, loading and starting it on first use.
+   */
+  library &load(const std::string &path) {
+    library *plugin;
+    {
+      std::lock_guard<std::mutex> lock(libraries_mutex);
+      std::unique_ptr<library> &slot = libraries[path];
+      if (!slot) {
+        slot.reset(new library());
+        slot->path = path;
+      }
+      plugin = slot.get();
+    }
+    // Other threads needing the same plugin wait here until it is ready.
+    std::call_once(plugin->loaded, [&]() {
+      plugin->module = LoadLibraryExA(path.c_str(), NULL, LOAD_WITH_ALTERED_SEARCH_PATH);
+      touch_plugin_init_function init = (plugin->module != NULL) ?
+        (touch_plugin_init_function)(void *)GetProcAddress(plugin->module, "touch_plugin_init") : nullptr;
+      touch_host host = {TOUCH_PLUGIN_ABI_VERSION, plugin, register_provider, log_error};
+      if (init == nullptr || init(&host) != 0) {
+        ERROR_PRINT("Error: Could not load plugin %s\n", path.c_str());
+        plugin->providers.clear();
+        if (plugin->module != NULL) FreeLibrary(plugin->module);
+        plugin->module = NULL;
+        plugin->failed = true;
+        return;
+      }
+      for (auto &provider : plugin->providers) {
+        provider.second.state = (provider.second.provider.begin_run != nullptr) ?
+          provider.second.provider.begin_run(provider.second.provider.context) : nullptr;
+      }
+    });
+    return *plugin;
+  }
+
+  /**
+   * @brief Prints an error the first time it happens.
+   */
+  void report(library &plugin, const std::string &message) {
+    std::lock_guard<std::mutex> lock(libraries_mutex);
+    if (plugin.reported.insert(message).second) {
+      ERROR_PRINT("%s\n", message.c_str());
+    }
+  }
+
+  /**
+   * @brief touch_host::register_provider, called from touch_plugin_init.
+   */
+  static int register_provider(void *host, const touch_provider *provider) {
+    library *plugin = (library *)host;
+    if (provider == nullptr || provider->name == nullptr || provider->evaluate == nullptr) return 1;
+    plugin->providers[provider->name] = {*provider, nullptr};
+    return 0;
+  }
+
+  /**
+   * @brief touch_host::log_error.
+   */
+  static void log_error(void *host, const char *message) {
+    ERROR_PRINT("Error: Plugin %s: %s\n", ((library *)host)->path.c_str(), message);
+  }
+
+  std::mutex libraries_mutex;
+  std::unordered_map<std::string, std::unique_ptr<library>> libraries;
+};
+
+/**
+ * @brief True once the plugin registry exists.
+ */
+std::atomic<bool> plugins_created(false);
+
+/**
+ * @brief The plugins of this run, created when the first plugin placeholder is rendered.
+ */
+plugin_registry &plugins() {
+  static plugin_registry registry;
+  plugins_created.store(true, std::memory_order_relaxed);
+  return registry;
+}
+
+/**
+ * @brief Ends the run of the loaded plugins, if any placeholder needed one.
+ */
+void finish_plugins() {
+  if (plugins_created.load()) plugins().finish();
+}
+
+/**
+ * @brief The rules of a CODEOWNERS file, compiled into an automaton over path components.
+ *
+ * Every pattern becomes a path through a trie of path components: literal components
+ * are looked up in a hash map, components with "*" or "?" are matched as globs and "**"
+ * becomes a node that loops on any component. Patterns share their common prefixes, and
+ * all patterns without a slash hang off the same leading "**", so matching a path costs
+ * one step per component over the few states that are active, however many rules the
+ * file has. The rule with the highest line number among the accepting states wins, as
+ * the last matching line does in CODEOWNERS.
+ */
+class owner_index {
+public:
+  owner_index() : nodes(1) {}
+
+  /**
+   * @brief Compiles a CODEOWNERS file.
+   * @return False if the file could not be read.
+   */
+  bool load(const std::string &path) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+    std::string line;
+    while (std::getline(file, line)) {
+      size_t pos = line.find_first_not_of(" \t\r");
+      if (pos == std::string::npos || line[pos] == '#') continue;
+      size_t end = line.find_first_of(" \t\r", pos);
+      std::string pattern = line.substr(pos, (end == std::string::npos) ? std::string::npos : end - pos);
+      std::string owners;
+      while (end != std::string::npos && (pos = line.find_first_not_of(" \t\r", end)) != std::string::npos &&
+             line[pos] != '#') {
+        end = line.find_first_of(" \t\r", pos);
+        if (!owners.empty()) owners += ' ';
+        owners += line.substr(pos, (end == std::string::npos) ? std::string::npos : end - pos);
+      }
+      add_rule(pattern, (unsigned)rule_owners.size());
+      rule_owners.push_back(owners);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Returns the states of the automaton before the first component of a path.
+   */
+  std::vector<unsigned> start() const {
+    std::vector<unsigned> states;
+    add_state(0, &states);
+    return states;
+  }
+
+  /**
+   * @brief Moves the automaton over one component of a path.
+   *
+   * @param component The component.
+   * @param last True for the file name, false for a directory.
+   * @param states The active states, replaced by the ones after the component.
+   * @param best The winning rule so far, -1 for none; updated with the rules that match.
+   */
+  void step(const std::string &component, bool last, std::vector<unsigned> *states, int *best) const {
+    std::vector<unsigned> next;
+    for (unsigned state : *states) {
+      const node &current = nodes[state];
+      if (current.any_depth) add_state(state, &next);
+      auto literal = current.literal.find(component);
+      if (literal != current.literal.end()) add_state(literal->second, &next);
+      for (const auto &glob : current.globs) {
+        if (glob_match(glob.first.c_str(), component.c_str())) add_state(glob.second, &next);
+      }
+    }
+    for (unsigned state : next) {
+      // A directory that matches makes everything inside it match.
+      *best = std::max(*best, last ? nodes[state].match : nodes[state].descendants);
+    }
+    states->swap(next);
+  }
+
+  /**
+   * @brief Returns the owners of a rule, separated by spaces.
+   */
+  const std::string &owners(int rule) const {
+    static const std::string none;
+    return (rule >= 0) ? rule_owners[rule] : none;
+  }
+
+private:
+  /**
+   * @brief A state of the automaton: the components of a pattern matched so far.
+   */
+  struct node {
+    std::unordered_map<std::string, unsigned> literal;   /**< Components without wildcards. */
+    std::vector<std::pair<std::string, unsigned>> globs; /**< Components with "*" or "?". */
+    int any = -1;            /**< The "**" node following this one, reached without a component. */
+    bool any_depth = false;  /**< True for a "**" node, which stays active on any component. */
+    int match = -1;          /**< The last rule matching a file that ends here. */
+    int descendants = -1;    /**< The last rule matching everything below this directory. */
+  };
+
+  /**
+   * @brief Adds a state and the "**" states reachable from it without a component.
+   */
+  void add_state(unsigned state, std::vector<unsigned> *states) const {
+    while (true) {
+      if (std::find(states->begin(), states->end(), state) == states->end()) states->push_back(state);
+      if (nodes[state].any < 0) return;
+      state = (unsigned)nodes[state].any;
+    }
+  }
+
+  /**
+   * @brief Matches a path component against a glob with "*" and "?".
+   */
+  static bool glob_match(const char *glob, const char *text) {
+    const char *star = nullptr;
+    const char *resume = nullptr;
+    while (*text != '\0') {
+      if (*glob == '*') {
+        star = glob++;
+        resume = text;
+      }
+      else if (*glob == '?' || *glob == *text) {
+        glob++;
+        text++;
+      }
+      else if (star != nullptr) {
+        glob = star + 1;
+        text = ++resume;
+      }
+      else {
+        return false;
+      }
+    }
+    while (*glob == '*') glob++;
+    return *glob == '\0';
+  }
+
+  /**
+   * @brief Adds the path of a pattern to the automaton.
+   *
+   * As in CODEOWNERS, a pattern without a slash (other than a trailing one) matches at
+   * any depth, a trailing slash only matches directories, a last component of "*" only
+   * matches the files directly inside its directory and anything else matches a file or
+   * everything inside a directory.
+   */
+  void add_rule(std::string pattern, unsigned rule) {
+    bool directory_only = pattern.size() > 1 && pattern.back() == '/';
+    if (directory_only) pattern.pop_back();
+    bool anchored = pattern.find('/') != std::string::npos;
+    if (!pattern.empty() && pattern[0] == '/') pattern.erase(0, 1);
+    std::vector<std::string> components;
+    if (!anchored) components.push_back("**");
+    for (size_t start = 0; start <= pattern.size();) {
+      size_t end = pattern.find('/', start);
+      if (end == std::string::npos) end = pattern.size();
+      std::string component = pattern.substr(start, end - start);
+      if (!component.empty() && !(component == "**" && !components.empty() && components.back() == "**")) {
+        components.push_back(component);
+      }
+      start = end + 1;
+    }
+    bool files_only = components.size() > 1 && components.back() == "*";
+    if (!components.empty() && components.back() == "**") {
+      components.pop_back();
+      directory_only = true;
+    }
+
+    unsigned state = 0;
+    for (const std::string &component : components) {
+      unsigned next;
+      if (component == "**") {
+        if (nodes[state].any < 0) {
+          nodes[state].any = (int)nodes.size();
+          nodes.emplace_back();
+          nodes.back().any_depth = true;
+        }
+        next = (unsigned)nodes[state].any;
+      }
+      else if (component.find_first_of("*?") == std::string::npos) {
+        auto found = nodes[state].literal.find(component);
+        if (found != nodes[state].literal.end()) {
+          next = found->second;
+        }
+        else {
+          next = (unsigned)nodes.size();
+          nodes[state].literal[component] = next;
+          nodes.emplace_back();
+        }
+      }
+      else {
+        auto &globs = nodes[state].globs;
+        auto found = std::find_if(globs.begin(), globs.end(), [&](const std::pair<std::string, unsigned> &glob) {
+          return glob.first == component;
+        });
+        if (found != globs.end()) {
+          next = found->second;
+        }
+        else {
+          next = (unsigned)nodes.size();
+          globs.push_back({component, next});
+          nodes.emplace_back();
+        }
+      }
+      state = next;
+    }
+    if (state == 0) return; // An empty pattern matches nothing.
+    if (!directory_only) nodes[state].match = (int)rule;
+    if (!files_only) nodes[state].descendants = (int)rule;
+  }
+
+  std::vector<node> nodes;              /**< The states, 0 being the repository root. */
+  std::vector<std::string> rule_owners; /**< The owners of every rule, by line. */
+};
+
+/**
+ * @brief Resolves the owners of files from the CODEOWNERS file of their repository.
+ *
+ * A repository is found by walking up to the first directory with a ".git" entry; its
+ * CODEOWNERS (in .github, the root or docs, as GitHub looks for it) is compiled once per
+ * run, and the repository of every directory is remembered. Every thread also keeps the
+ * automaton's states after the directory of its last file, so the files of a directory
+ * only take a single step each. reset() forgets all of it when the configuration is
+ * reloaded, so a long-running touch picks up edited CODEOWNERS files.
+ */
+class owner_resolver {
+public:
+  /**
+   * @brief Forgets every repository, so CODEOWNERS files are read again.
+   *
+   * Must not run while another thread resolves owners; the per-thread caches are dropped
+   * when their thread next resolves one.
+   */
+  void reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    directories.clear();
+    repositories.clear();
+    generation.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Returns the owners of a file, separated by spaces, or an empty string.
+   */
+  std::string owners_of(const std::string &filename) {
+    char buffer[MAX_PATH];
+    DWORD length = GetFullPathNameA(filename.c_str(), sizeof(buffer), buffer, nullptr);
+    if (length == 0 || length >= sizeof(buffer)) return std::string();
+    std::string path(buffer, length);
+    std::replace(path.begin(), path.end(), '\\', '/');
+    size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos) return std::string();
+    std::string directory = path.substr(0, slash);
+
+    // There is a single resolver per process, so the cache can be thread_local here.
+    thread_local std::string cached_directory;
+    thread_local const repository *cached_repository = nullptr;
+    thread_local std::vector<unsigned> cached_states;
+    thread_local int cached_best = -1;
+    thread_local unsigned cached_generation = 0;
+    unsigned current_generation = generation.load(std::memory_order_relaxed);
+    if (directory != cached_directory || cached_generation != current_generation) {
+      cached_directory = directory;
+      cached_generation = current_generation;
+      cached_repository = find_repository(directory);
+      cached_best = -1;
+      if (cached_repository != nullptr && cached_repository->index) {
+        const owner_index &index = *cached_repository->index;
+        cached_states = index.start();
+        std::string relative = directory.substr(std::min(directory.size(), cached_repository->root.size() + 1));
+        for (size_t start = 0; start < relative.size();) {
+          size_t end = relative.find('/', start);
+          if (end == std::string::npos) end = relative.size();
+          index.step(relative.substr(start, end - start), false, &cached_states, &cached_best);
+          start = end + 1;
+        }
+      }
+    }
+    if (cached_repository == nullptr || !cached_repository->index) return std::string();
+    std::vector<unsigned> states = cached_states;
+    int best = cached_best;
+    cached_repository->index->step(path.substr(slash + 1), true, &states, &best);
+    return cached_repository->index->owners(best);
+  }
+
+private:
+  /**
+   * @brief A repository and its compiled CODEOWNERS, if it has one.
+   */
+  struct repository {
+    std::string root;
+    std::unique_ptr<owner_index> index;
+  };
+
+  /**
+   * @brief Returns the repository a directory belongs to, or nullptr.
+   */
+  const repository *find_repository(const std::string &directory) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> visited;
+    const repository *found = nullptr;
+    std::string current = directory;
+    while (true) {
+      auto known = directories.find(current);
+      if (known != directories.end()) {
+        found = known->second;
+        break;
+      }
+      visited.push_back(current);
+      WIN32_FILE_ATTRIBUTE_DATA data;
+      if (GetFileAttributesExA((current + "/.git").c_str(), GetFileExInfoStandard, &data)) {
+        std::unique_ptr<repository> &slot = repositories[current];
+        slot.reset(new repository());
+        slot->root = current;
+        for (const char *location : {"/.github/CODEOWNERS", "/CODEOWNERS", "/docs/CODEOWNERS"}) {
+          std::unique_ptr<owner_index> index(new owner_index());
+          if (index->load(current + location)) {
+            slot->index = std::move(index);
+            break;
+          }
+        }
+        found = slot.get();
+        break;
+      }
+      size_t slash = current.find_last_of('/');
+      if (slash == std::string::npos || slash == 0) break;
+      current.erase(slash);
+    }
+    for (const std::string &path : visited) directories[path] = found;
+    return found;
+  }
+
+  std::mutex mutex;
+  std::unordered_map<std::string, std::unique_ptr<repository>> repositories;
+  std::unordered_map<std::string, const repository *> directories; /**< The repository of every directory seen. */
+  std::atomic<unsigned> generation{0}; /**< Counts the resets, to invalidate the per-thread caches. */
+};
+
+/**
+ * @brief True once the owner resolver exists.
+ */
+std::atomic<bool> owners_created(false);
+
+/**
+ * @brief The owners of the files of this run, created when the first <owner> is rendered.
+ */
+owner_resolver &owners() {
+  static owner_resolver resolver;
+  owners_created.store(true, std::memory_order_relaxed);
+  return resolver;
+}
+
+/**
+ * @brief Forgets the CODEOWNERS files read so far, if any <owner> was rendered.
+ */
+void reset_owners() {
+  if (owners_created.load()) owners().reset();
+}
+
+/**
+ * @brief Recognizes a "<seq>", "<seq:0001>", "<uuid>", "<uuid:v4>" or "<uuid:v7>" option,
+ * or a placeholder of a plugin in plugin_map.
+ *
+ * The digits of a sequence give its first number and width: "<seq:0001>" numbers the
+ * files 0001, 0002 and so on, "<seq>" numbers them 1, 2 and so on.
+ *
+ * @param option The option.
+ * @param kind Set to SEGMENT_SEQ, SEGMENT_UUID or SEGMENT_PLUGIN, if not null.
+ * @param spec Set to the part after the colon, if not null. For a plugin it is the
+ *             plugin's DLL, a "|" and the option without its brackets.
+ * @return True if the option is a valid sequence, UUID or plugin placeholder.
+ */
+bool parse_placeholder(const std::string &option, unsigned *kind, std::string *spec) {
+  std::string value;
+  unsigned found;
+  if (option == "<seq>" || option == "<uuid>") {
+    found = (option == "<seq>") ? SEGMENT_SEQ : SEGMENT_UUID;
+  }
+  else if (option.compare(0, 5, "<seq:") == 0 && option.back() == '>') {
+    found = SEGMENT_SEQ;
+    value = option.substr(5, option.size() - 6);
+    if (value.empty() || value.size() > 19 || value.find_first_not_of("0123456789") != std::string::npos) return false;
+  }
+  else if (option == "<uuid:v4>" || option == "<uuid:v7>") {
+    found = SEGMENT_UUID;
+    value = option.substr(6, 2);
+  }
+  else if (!plugin_map.empty() && option.size() > 2 && option.front() == '<' && option.back() == '>') {
+    std::string placeholder = option.substr(1, option.size() - 2);
+    auto plugin = plugin_map.find(placeholder.substr(0, placeholder.find(':')));
+    if (plugin == plugin_map.end()) return false;
+    found = SEGMENT_PLUGIN;
+    value = plugin->second + "|" + placeholder;
+  }
+  else {
+    return false;
+  }
+  if (kind != nullptr) *kind = found;
+  if (spec != nullptr) *spec = value;
+  return true;
+}
+
+/**
+ * @brief The values of the placeholders of one file.
+ *
+ * A value is drawn when the first placeholder needs it and then reused, so all "<seq>"
+ * placeholders of a file show the same number and files without one use up none. The
+ * same goes for plugins, which are asked once per file and placeholder.
+ */
+class render_values {
+public:
+  /**
+   * @param filename The file the values are for, passed on to plugins.
+   */
+  explicit render_values(const std::string &filename) : filename(filename), have_number(false), number(0) {}
+
+  /**
+   * @brief Returns the text of a placeholder segment.
+   * @param kind SEGMENT_DATE, SEGMENT_SEQ, SEGMENT_UUID, SEGMENT_PLUGIN or SEGMENT_OWNER.
+   * @param spec The text of the segment.
+   * @param spec_length The length of spec.
+   */
+  std::string value(unsigned kind, const char *spec, size_t spec_length) {
+    if (kind == SEGMENT_DATE) {
+      return get_current_date();
+    }
+    if (kind == SEGMENT_SEQ) {
+      if (!have_number) {
+        number = sequence.next();
+        have_number = true;
+      }
+      unsigned long long start = (spec_length > 0) ? strtoull(std::string(spec, spec_length).c_str(), nullptr, 10) : 1;
+      char buffer[32];
+      snprintf(buffer, sizeof(buffer), "%0*llu", (int)std::min<size_t>(spec_length, 20), start + number - 1);
+      return buffer;
+    }
+    if (kind == SEGMENT_OWNER) {
+      return owners().owners_of(filename);
+    }
+    if (kind == SEGMENT_PLUGIN) {
+      std::string key(spec, spec_length);
+      for (const auto &known : plugin_values) {
+        if (known.first == key) return known.second;
+      }
+      plugin_values.push_back({key, plugins().evaluate(key, filename)});
+      return plugin_values.back().second;
+    }
+    std::string &uuid = (spec_length == 2 && spec[1] == '7') ? uuid_v7 : uuid_v4;
+    if (uuid.empty()) {
+      uuid = generate_uuid((&uuid == &uuid_v7) ? 7 : 4);
+    }
+    return uuid;
+  }
+
+  /**
+   * @brief value() as a plain function, for the generated render functions.
+   */
+  static std::string callback(void *context, unsigned kind, const char *spec) {
+    return ((render_values *)context)->value(kind, spec, strlen(spec));
+  }
+
+private:
+  const std::string &filename;
+  bool have_number;
+  unsigned long long number;
+  std::string uuid_v4;
+  std::string uuid_v7;
+  std::vector<std::pair<std::string, std::string>> plugin_values; /**< Plugin placeholders and their values. */
+};
+
+/**
+ * @brief Parses the configuration file.
+ *
+ * This function reads the configuration file line by line and processes various commands:
+ * - "SET" commands to define variables.
+ * - "<type ...>" commands to declare option types.
+ * - "<prepend>", "<append>", and "<raw>" markers to set context for options.
+ * - "<license:ID>" options, which insert the text of a bundled SPDX license.
+ * - "<seq>", "<seq:0001>" and "<uuid>" options, which number the files of a run and
+ *   give each one a UUID.
+ * - "<owner>" options, which name the owners of a file from the CODEOWNERS file of its
+ *   repository.
+ * - "PLUGIN" commands naming a plugin DLL and the placeholders it provides, which may
+ *   then be used as options like any other placeholder (see touch_plugin.h).
+ * - "eol=lf|crlf", "bom=utf-8|none" and "comment=line|block" settings of a type, given
+ *   before its "<raw>" marker.
+ *
+ * Options and raw code are stored in the global maps for later processing, so the
+ * configuration only has to be parsed once no matter how many files are created.
+ *
+ * @param filename The path to the configuration file.
+ */
+void parse_config_file(const char *filename) {
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    ERROR_PRINT("Error: Could not open configuration file %s\n", filename);
+    return;
+  }
+
+  std::string line;
+  std::string current_type = "";
+  bool is_prepend = false;
+  bool is_raw = false;
+  std::string license_text;
+  while (std::getline(file, line)) {
+    // Trim leading and trailing whitespace.
+    line.erase(0, line.find_first_not_of(" \t"));
+    line.erase(line.find_last_not_of(" \t") + 1);
+
+    // Skip empty lines.
+    if (line.empty()) continue;
+
+    if (line.find("SET ") == 0) {
+      // Process SET commands.
+      size_t pos = 4;
+      size_t equal_pos = line.find('=', pos);
+      if (equal_pos == std::string::npos) {
+        ERROR_PRINT("Error: Invalid SET command syntax: %s\n", line.c_str());
+        continue;
+      }
+      std::string var_name = line.substr(pos, equal_pos - pos);
+      var_name.erase(0, var_name.find_first_not_of(" \t"));
+      var_name.erase(var_name.find_last_not_of(" \t") + 1);
+      
+      std::string var_value = line.substr(equal_pos + 1);
+      var_value.erase(0, var_value.find_first_not_of(" \t"));
+      var_value.erase(var_value.find_last_not_of(" \t") + 1);
+
+      // Remove surrounding quotes if present.
+      if (!var_value.empty() && var_value.front() == '"' && var_value.back() == '"') {
+        var_value = var_value.substr(1, var_value.size() - 2);
+      }
+
+      // Store variables with angle brackets for easy substitution.
+      variable_map["<" + var_name + ">"] = var_value;
+      continue;
+    }
+    else if (line.find("PLUGIN ") == 0) {
+      // PLUGIN "path\to\plugin.dll" name..., the path relative to the configuration file.
+      size_t pos = line.find_first_not_of(" \t", 7);
+      size_t end = (pos != std::string::npos && line[pos] == '"') ? line.find('"', pos + 1) : line.find_first_of(" \t", pos);
+      std::string library;
+      if (pos != std::string::npos && end != std::string::npos) {
+        library = (line[pos] == '"') ? line.substr(pos + 1, end - pos - 1) : line.substr(pos, end - pos);
+      }
+      if (library.empty()) {
+        ERROR_PRINT("Error: Invalid PLUGIN command syntax: %s\n", line.c_str());
+        continue;
+      }
+      bool absolute = (library.size() > 1 && library[1] == ':') || library[0] == '\\' || library[0] == '/';
+      if (!absolute) {
+        std::string config = filename;
+        library = config.substr(0, config.find_last_of("\\/") + 1) + library;
+      }
+      pos = line.find_first_not_of(" \t", end + 1);
+      while (pos != std::string::npos) {
+        end = line.find_first_of(" \t", pos);
+        std::string name = line.substr(pos, (end == std::string::npos) ? std::string::npos : end - pos);
+        bool reserved = std::any_of(std::begin(reserved_names), std::end(reserved_names),
+                                    [&](const char *reserved_name) { return name == reserved_name; });
+        if (reserved || name.find_first_of("<>:|") != std::string::npos) {
+          ERROR_PRINT("Error: Invalid plugin placeholder %s\n", name.c_str());
+        }
+        else {
+          plugin_map[name] = library;
+        }
+        pos = (end == std::string::npos) ? end : line.find_first_not_of(" \t", end);
+      }
+      continue;
+    }
+    else if (line.find("<type ") == 0) {
+      // Extract type name.
+      current_type = line.substr(6, line.size() - 7);
+      is_prepend = false;
+      is_raw = false;
+      if (type_options_map.find(current_type) == type_options_map.end()) {
+        type_options_map[current_type] = std::vector<option>();
+      }
+      DEBUG_PRINT("Found type: %s\n", current_type.c_str());
+      continue;
+    }
+    else if (line.find("<prepend>") == 0) {
+      is_prepend = true;
+      DEBUG_PRINT("Found prepend\n");
+      continue;
+    }
+    else if (line.find("<append>") == 0) {
+      is_prepend = false;
+      DEBUG_PRINT("Found append\n");
+      continue;
+    }
+    else if (line.find("<raw>") == 0) {
+      is_raw = true;
+      DEBUG_PRINT("Found raw\n");
+      continue;
+    }
+    else if (!is_raw && !current_type.empty() &&
+             (line.find("eol=") == 0 || line.find("bom=") == 0 || line.find("comment=") == 0)) {
+      std::string value = line.substr(line.find('=') + 1);
+      if (line[0] == 'e' && (value == "lf" || value == "crlf")) {
+        type_settings_map[current_type].eol = value;
+      }
+      else if (line[0] == 'b' && (value == "utf-8" || value == "none")) {
+        type_settings_map[current_type].bom = value;
+      }
+      else if (line[0] == 'c' && (value == "line" || value == "block")) {
+        type_settings_map[current_type].comment = value;
+      }
+      else {
+        ERROR_PRINT("Error: Invalid setting %s for type %s\n", line.c_str(), current_type.c_str());
+      }
+      DEBUG_PRINT("Found setting: %s\n", line.c_str());
+      continue;
+    }
+    else {
+      // Treat any other line as an option if inside a type block.
+      if (current_type.empty()) {
+        ERROR_PRINT("Error: Option %s is not inside a type block\n", line.c_str());
+      } 
+      else if (is_raw) {
+        DEBUG_PRINT("Found raw option: %s\n", line.c_str());
+        type_raw_map[current_type].push_back(line);
+      }
+      else if (line.compare(0, 9, "<license:") == 0 && line.back() == '>' &&
+               !find_license(line.substr(9, line.size() - 10), nullptr, &license_text)) {
+        ERROR_PRINT("Error: Unknown license %s\n", line.substr(9, line.size() - 10).c_str());
+      }
+      else if ((line.compare(0, 5, "<seq:") == 0 || line.compare(0, 6, "<uuid:") == 0) &&
+               !parse_placeholder(line, nullptr, nullptr)) {
+        ERROR_PRINT("Error: Invalid placeholder %s\n", line.c_str());
+      }
+      else {
+        DEBUG_PRINT("Found option: %s\n", line.c_str());
+        type_options_map[current_type].push_back({line, is_prepend});
+      }
+    }
+  }
+}
+
+/**
+ * @brief Identifies one version of a configuration file, to tell whether a cache is current.
+ */
+struct config_stamp {
+  unsigned long long size;  /**< Size of the configuration file in bytes. */
+  unsigned long long mtime; /**< Last write time of the configuration file as FILETIME ticks. */
+};
+
+/**
+ * @brief Header of a compiled configuration cache file.
+ *
+ * It is followed by the compiled configuration (see flat_config_header), which holds no
+ * pointers and is used in place wherever the file is mapped.
+ */
+struct config_cache_header {
+  char magic[8];                   /**< "TOUCHCC" and a NUL. */
+  unsigned version;                /**< CONFIG_CACHE_VERSION. */
+  unsigned reserved;
+  config_stamp stamp;              /**< The configuration file the cache was compiled from. */
+  unsigned long long payload_size; /**< Bytes following the header. */
+};
+
+/**
+ * @brief Computes the 64-bit FNV-1a hash of a buffer.
+ */
+unsigned long long fnv1a_hash(const void *data, size_t size, unsigned long long hash = 14695981039346656037ULL) {
+  const unsigned char *bytes = (const unsigned char *)data;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+/**
+ * @brief A string in the pool of a compiled configuration.
+ */
+struct flat_string {
+  unsigned offset; /**< Offset of the first character from the start of the pool. */
+  unsigned length;
+};
+
+/**
+ * @brief One piece of a render plan.
+ */
+struct flat_segment {
+  unsigned kind;    /**< A segment_kind. */
+  flat_string text; /**< The text of a SEGMENT_LITERAL, empty otherwise. */
+};
+
+/**
+ * @brief The render plan of one file extension: its message as a run of segments.
+ */
+struct flat_plan {
+  flat_string extension;  /**< The extension including the dot. */
+  unsigned first_segment; /**< Index of the plan's first segment. */
+  unsigned segment_count;
+};
+
+/**
+ * @brief Header of a compiled configuration.
+ *
+ * A compiled configuration is a single buffer in the style of FlatBuffers: this header,
+ * the plans sorted by extension, the segments of all plans and a pool with the text of
+ * every string. Everything refers to everything else by offset or index, so the buffer
+ * can be written to disk, mapped at any address and used in place. All values are
+ * little-endian, which is what every Windows target is.
+ */
+struct flat_config_header {
+  char magic[8];             /**< "TOUCHCF" and a NUL. */
+  unsigned size;             /**< Size of the whole buffer. */
+  unsigned plan_count;
+  unsigned plans_offset;     /**< Offset of the flat_plan array, sorted by extension. */
+  unsigned segment_count;
+  unsigned segments_offset;  /**< Offset of the flat_segment array. */
+  unsigned pool_offset;      /**< Offset of the string pool. */
+  unsigned pool_size;
+  flat_plan default_plan;    /**< The plan for extensions without a plan of their own. */
+};
+
+/**
+ * @brief Read-only access to a compiled configuration, used in place.
+ */
+class config_view {
+public:
+  config_view() : data(nullptr) {}
+
+  /**
+   * @brief Validates a compiled configuration and makes it the one the view reads.
+   *
+   * Every offset, index and length is checked against the size of the buffer, so a
+   * damaged cache file is rejected instead of being read out of bounds.
+   *
+   * @param buffer The compiled configuration. It must stay valid while the view is used.
+   * @param size The size of the buffer.
+   * @return True if the buffer is a valid compiled configuration.
+   */
+  bool attach(const char *buffer, size_t size) {
+    if (size < sizeof(flat_config_header) || ((size_t)buffer % alignof(flat_config_header)) != 0) return false;
+    const flat_config_header *header = (const flat_config_header *)buffer;
+    if (memcmp(header->magic, "TOUCHCF", 8) != 0 || header->size != size) return false;
+    if (!array_fits(size, header->plans_offset, header->plan_count, sizeof(flat_plan)) ||
+        !array_fits(size, header->segments_offset, header->segment_count, sizeof(flat_segment)) ||
+        !array_fits(size, header->pool_offset, header->pool_size, 1)) {
+      return false;
+    }
+    const flat_plan *plans = (const flat_plan *)(buffer + header->plans_offset);
+    const flat_segment *segments = (const flat_segment *)(buffer + header->segments_offset);
+    for (unsigned i = 0; i <= header->plan_count; i++) {
+      const flat_plan &plan = (i < header->plan_count) ? plans[i] : header->default_plan;
+      if (!string_fits(*header, plan.extension) ||
+          plan.first_segment > header->segment_count ||
+          plan.segment_count > header->segment_count - plan.first_segment) {
+        return false;
+      }
+      // Plans have to be sorted for the binary search in find_plan().
+      if (i > 0 && i < header->plan_count &&
+          compare(buffer + header->pool_offset, plans[i - 1].extension, plan.extension) >= 0) {
+        return false;
+      }
+    }
+    for (unsigned i = 0; i < header->segment_count; i++) {
+      if (segments[i].kind > SEGMENT_OWNER || !string_fits(*header, segments[i].text)) return false;
+    }
+    data = buffer;
+    return true;
+  }
+
+  /**
+   * @brief True once a compiled configuration is attached.
+   */
+  bool attached() const {
+    return data != nullptr;
+  }
+
+  /**
+   * @brief Renders the message for a file.
+   * @param filename The name of the file, used for SEGMENT_FILE.
+   * @param file_extension The extension of the file, including the dot.
+   * @param values The values of the file's other placeholders.
+   */
+  std::string render(const std::string &filename, const std::string &file_extension, render_values &values) const {
+    std::string message;
+    if (data == nullptr) return message;
+    const flat_config_header *header = (const flat_config_header *)data;
+    const flat_plan &plan = find_plan(file_extension);
+    const flat_segment *segments = (const flat_segment *)(data + header->segments_offset) + plan.first_segment;
+    const char *pool = data + header->pool_offset;
+    size_t length = 0;
+    for (unsigned i = 0; i < plan.segment_count; i++) {
+      length += (segments[i].kind == SEGMENT_LITERAL) ? segments[i].text.length : filename.size() + 36;
+    }
+    message.reserve(length);
+    for (unsigned i = 0; i < plan.segment_count; i++) {
+      switch (segments[i].kind) {
+        case SEGMENT_LITERAL: message.append(pool + segments[i].text.offset, segments[i].text.length); break;
+        case SEGMENT_FILE:    message += filename; break;
+        default:              message += values.value(segments[i].kind, pool + segments[i].text.offset, segments[i].text.length); break;
+      }
+    }
+    return message;
+  }
+
+private:
+  /**
+   * @brief Looks up the plan of an extension by binary search, or the default plan.
+   */
+  const flat_plan &find_plan(const std::string &file_extension) const {
+    const flat_config_header *header = (const flat_config_header *)data;
+    const flat_plan *plans = (const flat_plan *)(data + header->plans_offset);
+    const char *pool = data + header->pool_offset;
+    unsigned low = 0;
+    unsigned high = header->plan_count;
+    while (low < high) {
+      unsigned middle = low + (high - low) / 2;
+      const flat_string &key = plans[middle].extension;
+      size_t common = std::min<size_t>(key.length, file_extension.size());
+      int order = memcmp(pool + key.offset, file_extension.data(), common);
+      if (order == 0) order = (key.length < file_extension.size()) ? -1 : (key.length > file_extension.size());
+      if (order == 0) return plans[middle];
+      if (order < 0) low = middle + 1;
+      else high = middle;
+    }
+    return header->default_plan;
+  }
+
+  static bool array_fits(size_t size, unsigned offset, unsigned count, size_t element_size) {
+    return offset % 4 == 0 && offset <= size && count <= (size - offset) / element_size;
+  }
+
+  static bool string_fits(const flat_config_header &header, const flat_string &string) {
+    return string.offset <= header.pool_size && string.length <= header.pool_size - string.offset;
+  }
+
+  static int compare(const char *pool, const flat_string &a, const flat_string &b) {
+    int order = memcmp(pool + a.offset, pool + b.offset, std::min(a.length, b.length));
+    return (order != 0) ? order : (a.length < b.length) ? -1 : (a.length > b.length);
+  }
+
+  const char *data;
+};
+
+/**
+ * @brief The compiled configuration files are rendered from.
+ */
+config_view compiled_config;
+
+/**
+ * @brief True if files are rendered by the built-in templates, which is the case when
+ * no configuration file exists.
+ */
+bool use_generated_templates = false;
+
+/**
+ * @brief True if the file list is read from stdin (--files-from=-), which leaves no way
+ * to answer a confirmation prompt.
+ */
+bool stdin_file_list = false;
+
+/**
+ * @brief The buffer of a configuration compiled by this process. A configuration loaded
+ * from the cache is read from the mapped file instead.
+ */
+std::string compiled_config_storage;
+
+/**
+ * @brief The mapped view of the cache file compiled_config reads from, or null.
+ */
+const char *config_cache_view = nullptr;
+
+/**
+ * @brief Remembers the view compiled_config now reads from and unmaps the previous one.
+ *
+ * Called once compiled_config is attached to its new buffer, so a reload of a
+ * long-running touch doesn't keep every view it ever mapped.
+ *
+ * @param view The new view, or null if compiled_config reads from compiled_config_storage.
+ */
+void replace_config_cache_view(const char *view) {
+  if (config_cache_view != nullptr && config_cache_view != view) {
+    UnmapViewOfFile(config_cache_view);
+  }
+  config_cache_view = view;
+}
+
+/**
+ * @brief Returns an output setting of a type, falling back to the one of ".all".
+ * @param file_extension The type.
+ * @param field The setting, e.g. &type_settings::eol.
+ * @return The value, or an empty string if neither sets it.
+ */
+std::string type_setting(const std::string &file_extension, std::string type_settings::*field) {
+  auto settings = type_settings_map.find(file_extension);
+  if (settings != type_settings_map.end() && !(settings->second.*field).empty()) {
+    return settings->second.*field;
+  }
+  settings = type_settings_map.find(".all");
+  return (settings != type_settings_map.end()) ? settings->second.*field : std::string();
+}
+
+/**
+ * @brief Builds the render plan of one extension from the parsed configuration.
+ *
+ * The plan renders the same message the options would: the prepended options of the
+ * type, the ".all" defaults and the appended options, each as a comment line or framed
+ * together in one block comment, followed by the raw code. Variables, comment framing
+ * and raw code markers are resolved here, so only the file name, the date, the sequence
+ * number and the UUID are left for rendering.
+ *
+ * The type's line endings (CRLF unless it sets "eol=lf") and byte order mark are applied
+ * to the literal text as well: none of the rendered values contain a line break, so the
+ * rendered messages never need a conversion pass.
+ *
+ * @param file_extension The extension, or an empty string for the default plan.
+ * @param segments The list to append the plan's segments to, as kind and text.
+ */
+void build_render_plan(const std::string &file_extension, std::vector<std::pair<unsigned, std::string>> *segments) {
+  auto literal = [&](const std::string &text) {
+    if (text.empty()) return;
+    if (!segments->empty() && segments->back().first == SEGMENT_LITERAL) {
+      segments->back().second += text;
+    }
+    else {
+      segments->push_back({SEGMENT_LITERAL, text});
+    }
+  };
+
+  std::vector<std::string> all_options;
+  auto type_options = type_options_map.find(file_extension);
+  auto default_options = type_options_map.find(".all");
+  if (type_options != type_options_map.end()) {
+    for (const option &opt : type_options->second) {
+      if (opt.is_prepend) all_options.push_back(opt.identifier);
+    }
+  }
+  if (default_options != type_options_map.end()) {
+    for (const option &opt : default_options->second) {
+      all_options.push_back(opt.identifier);
+    }
+  }
+  if (type_options != type_options_map.end()) {
+    for (const option &opt : type_options->second) {
+      if (!opt.is_prepend) all_options.push_back(opt.identifier);
+    }
+  }
+
+  const comment_style *found_style = find_comment_style(file_extension);
+  const comment_style &style = (found_style != nullptr) ? *found_style : default_comment_style;
+  bool block = style.line == nullptr ||
+               (style.block_open != nullptr && type_setting(file_extension, &type_settings::comment) == "block");
+  std::string comment_str = block ? style.block_line : style.line;
+  if (block && !all_options.empty()) {
+    literal(std::string(style.block_open) + "\n");
+  }
+  for (const std::string &opt : all_options) {
+    if (opt.compare(0, 9, "<license:") == 0 && opt.back() == '>') {
+      // The text is reflowed to fit behind the comment prefix, one comment line per line.
+      std::string id;
+      std::string text;
+      find_license(opt.substr(9, opt.size() - 10), &id, &text);
+      std::string copyright = convert_option("<copyright>", std::string());
+      for (size_t pos = text.find("<copyright>"); pos != std::string::npos; pos = text.find("<copyright>", pos + copyright.size())) {
+        text.replace(pos, 11, copyright);
+      }
+      std::string empty_line = comment_str.substr(0, comment_str.find_last_not_of(' ') + 1);
+      std::vector<std::string> lines = reflow_text(text, LICENSE_WIDTH - std::min<size_t>(comment_str.size(), LICENSE_WIDTH / 2));
+      lines.insert(lines.begin(), {"SPDX-License-Identifier: " + id, std::string()});
+      for (const std::string &line : lines) {
+        literal((line.empty() ? empty_line : comment_str + line) + "\n");
+      }
+      continue;
+    }
+    literal(comment_str);
+    unsigned kind;
+    std::string spec;
+    if (parse_placeholder(opt, &kind, &spec)) {
+      if (kind == SEGMENT_PLUGIN) {
+        // Labeled like the built-in placeholders: <ticket:ARG> renders "TICKET: value".
+        std::string label = opt.substr(1, std::min(opt.find(':'), opt.size() - 1) - 1);
+        std::transform(label.begin(), label.end(), label.begin(), [](char c) { return (char)toupper((unsigned char)c); });
+        literal(label + ": ");
+      }
+      else {
+        literal(kind == SEGMENT_SEQ ? "SEQ: " : "UUID: ");
+      }
+      segments->push_back({kind, spec});
+    }
+    else if (opt == "<date>") {
+      literal("DATE: ");
+      segments->push_back({SEGMENT_DATE, std::string()});
+    }
+    else if (opt == "<file>") {
+      literal("FILE: ");
+      segments->push_back({SEGMENT_FILE, std::string()});
+    }
+    else if (opt == "<owner>") {
+      literal("OWNER: ");
+      segments->push_back({SEGMENT_OWNER, std::string()});
+    }
+    else {
+      literal(convert_option(opt, std::string()));
+    }
+    literal("\n");
+  }
+  if (block && !all_options.empty()) {
+    literal(std::string(style.block_close) + "\n");
+  }
+
+  auto raw_it = type_raw_map.find(file_extension);
+  if (raw_it != type_raw_map.end() && !raw_it->second.empty()) {
+    // Add a newline before the raw code.
+    literal("\n");
+    for (const auto &line : raw_it->second) {
       // Remove any surrounding single or double quotes.
       std::string trimmed = line;
       if (!trimmed.empty() && (trimmed.front() == '\"' || trimmed.front() == '\'')) {
         trimmed = trimmed.substr(1, trimmed.size() - 2);
       }
-      if (trimmed == "\\n") {
-        file_message += "\n";
+      literal(trimmed == "\\n" ? "\n" : line + "\n");
+    }
+  }
+
+  // CRLF unless the type opts into LF, as the files written in text mode always had.
+  if (type_setting(file_extension, &type_settings::eol) != "lf") {
+    for (auto &segment : *segments) {
+      if (segment.first != SEGMENT_LITERAL) continue;
+      std::string converted;
+      converted.reserve(segment.second.size() + segment.second.size() / 16);
+      for (size_t i = 0; i < segment.second.size(); i++) {
+        if (segment.second[i] == '\n' && (i == 0 || segment.second[i - 1] != '\r')) converted += '\r';
+        converted += segment.second[i];
+      }
+      segment.second.swap(converted);
+    }
+  }
+  if (type_setting(file_extension, &type_settings::bom) == "utf-8") {
+    if (segments->empty() || segments->front().first != SEGMENT_LITERAL) {
+      segments->insert(segments->begin(), {SEGMENT_LITERAL, std::string()});
+    }
+    segments->front().second.insert(0, "\xEF\xBB\xBF");
+  }
+}
+
+/**
+ * @brief The extensions that get a render plan of their own, sorted.
+ *
+ * A plan is compiled for every extension that has a type block or a known comment
+ * style; any other extension renders with the default plan.
+ */
+std::vector<std::string> plan_extensions() {
+  std::vector<std::string> extensions;
+  for (const auto &type : type_options_map) extensions.push_back(type.first);
+  for (const auto &type : type_raw_map) extensions.push_back(type.first);
+  for (const auto &type : type_settings_map) extensions.push_back(type.first);
+  for (const comment_style_entry &style : comment_styles) extensions.push_back(style.extension);
+  std::sort(extensions.begin(), extensions.end());
+  extensions.erase(std::unique(extensions.begin(), extensions.end()), extensions.end());
+  return extensions;
+}
+
+/**
+ * @brief Compiles the parsed configuration into the flat layout read by config_view.
+ * @return The compiled configuration.
+ */
+std::string compile_config() {
+  std::vector<std::string> extensions = plan_extensions();
+  std::vector<flat_plan> plans;
+  std::vector<flat_segment> segments;
+  std::string pool;
+  auto add_string = [&](const std::string &text) {
+    flat_string string = {(unsigned)pool.size(), (unsigned)text.size()};
+    pool += text;
+    return string;
+  };
+  auto add_plan = [&](const std::string &file_extension) {
+    std::vector<std::pair<unsigned, std::string>> plan_segments;
+    build_render_plan(file_extension, &plan_segments);
+    flat_plan plan = {add_string(file_extension), (unsigned)segments.size(), (unsigned)plan_segments.size()};
+    for (const auto &segment : plan_segments) {
+      segments.push_back({segment.first, add_string(segment.second)});
+    }
+    return plan;
+  };
+  for (const std::string &file_extension : extensions) {
+    plans.push_back(add_plan(file_extension));
+  }
+
+  flat_config_header header = {};
+  memcpy(header.magic, "TOUCHCF", 8);
+  header.default_plan = add_plan(std::string());
+  header.plan_count = (unsigned)plans.size();
+  header.plans_offset = sizeof(header);
+  header.segment_count = (unsigned)segments.size();
+  header.segments_offset = header.plans_offset + (unsigned)(plans.size() * sizeof(flat_plan));
+  header.pool_offset = header.segments_offset + (unsigned)(segments.size() * sizeof(flat_segment));
+  header.pool_size = (unsigned)pool.size();
+  header.size = header.pool_offset + header.pool_size;
+
+  std::string out;
+  out.reserve(header.size);
+  out.append((const char *)&header, sizeof(header));
+  out.append((const char *)plans.data(), plans.size() * sizeof(flat_plan));
+  out.append((const char *)segments.data(), segments.size() * sizeof(flat_segment));
+  out.append(pool);
+  return out;
+}
+
+/**
+ * @brief Compiles the parsed configuration and renders from it from now on.
+ */
+void use_parsed_config() {
+  phase_timer timer(PHASE_COMPILE);
+  compiled_config_storage = compile_config();
+  compiled_config.attach(compiled_config_storage.data(), compiled_config_storage.size());
+  replace_config_cache_view(nullptr);
+  TRACE_POINT("PlanCompile", TraceLoggingUInt64(compiled_config_storage.size(), "Bytes"));
+}
+
+/**
+ * @brief Writes a buffer to standard output as is, without newline translation.
+ * @return True if the whole buffer was written.
+ */
+bool write_stdout(const std::string &data) {
+  return write_all(GetStdHandle(STD_OUTPUT_HANDLE), data.data(), data.size());
+}
+
+/**
+ * @brief Quotes text as a C++ string literal. Anything but printable ASCII is escaped.
+ */
+std::string cpp_quote(const std::string &text) {
+  std::string out = "\"";
+  for (char c : text) {
+    unsigned char byte = (unsigned char)c;
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    }
+    else if (c == '\n') {
+      out += "\\n";
+    }
+    else if (c == '\t') {
+      out += "\\t";
+    }
+    else if (byte < 0x20 || byte >= 0x7F || c == '?') {
+      // Octal escapes stop after three digits, so they can't swallow the next character.
+      // '?' is escaped to rule out trigraphs.
+      char escaped[5];
+      snprintf(escaped, sizeof(escaped), "\\%03o", byte);
+      out += escaped;
+    }
+    else {
+      out += c;
+    }
+  }
+  out += '"';
+  return out;
+}
+
+/**
+ * @brief Writes a C++ header with the render plans of a configuration file to stdout.
+ *
+ * The header (generated_templates.hpp) has one render function per plan, which appends
+ * the literal text, fills in the file name and asks a callback for the date, sequence
+ * number, UUID and plugin placeholders, and a constexpr table of the
+ * extensions sorted for binary search. Building touch with TOUCH_GENERATED_TEMPLATES
+ * defined compiles them in, so the binary renders without reading any configuration.
+ *
+ * @param config_path The configuration file to compile.
+ * @return EXIT_SUCCESS if the header was written.
+ */
+int emit_cpp(const char *config_path) {
+  std::ifstream probe(config_path);
+  if (!probe.is_open()) {
+    ERROR_PRINT("Error: Could not open configuration file %s\n", config_path);
+    return EXIT_FAILURE;
+  }
+  probe.close();
+  parse_config_file(config_path);
+
+  std::string base_name = config_path;
+  base_name = base_name.substr(base_name.find_last_of("\\/") + 1);
+  std::string out;
+  out += "// Render functions for the touch command.\n";
+  out += "// Generated by `touch --emit-cpp " + base_name + "`, do not edit.\n";
+  out += "#pragma once\n\n#include <cstddef>\n#include <cstring>\n#include <string>\n\n";
+  out += "namespace generated_templates {\n\n";
+  out += "// Returns the value of a placeholder: kind 2 is the date, 3 the sequence number, 4 a UUID,\n";
+  out += "// 5 a placeholder of a plugin and 6 the owners.\n";
+  out += "typedef std::string (*value_function)(void *context, unsigned kind, const char *spec);\n";
+  out += "typedef void (*render_function)(std::string &out, const std::string &filename, value_function value, void *context);\n\n";
+
+  std::vector<std::string> extensions = plan_extensions();
+  extensions.push_back(std::string()); // The default plan comes last.
+  for (size_t i = 0; i < extensions.size(); i++) {
+    std::vector<std::pair<unsigned, std::string>> segments;
+    build_render_plan(extensions[i], &segments);
+    size_t literal_size = 0;
+    size_t value_size = 0;
+    bool uses_values = false;
+    bool uses_filename = false;
+    for (const auto &segment : segments) {
+      if (segment.first == SEGMENT_LITERAL) literal_size += segment.second.size();
+      if (segment.first == SEGMENT_DATE) value_size += 10;
+      if (segment.first == SEGMENT_SEQ) value_size += std::max<size_t>(segment.second.size(), 1);
+      if (segment.first == SEGMENT_UUID) value_size += 36;
+      uses_values |= segment.first != SEGMENT_LITERAL && segment.first != SEGMENT_FILE;
+      uses_filename |= segment.first == SEGMENT_FILE;
+    }
+    out += "// " + (extensions[i].empty() ? std::string("Any other extension") : extensions[i]) + "\n";
+    out += "inline void render_" + std::to_string(i) +
+           "(std::string &out, const std::string &filename, value_function value, void *context) {\n";
+    if (!uses_filename) out += "  (void)filename;\n";
+    if (!uses_values) out += "  (void)value;\n  (void)context;\n";
+    out += "  out.reserve(" + std::to_string(literal_size + value_size) + (uses_filename ? " + filename.size()" : "") + ");\n";
+    for (const auto &segment : segments) {
+      if (segment.first == SEGMENT_FILE) {
+        out += "  out += filename;\n";
+      }
+      else if (segment.first != SEGMENT_LITERAL) {
+        out += "  out += value(context, " + std::to_string(segment.first) + ", " + cpp_quote(segment.second) + ");\n";
+      }
+      else {
+        // Long literals are split, compilers limit the length of a single literal.
+        for (size_t pos = 0; pos < segment.second.size(); pos += 2048) {
+          std::string piece = segment.second.substr(pos, 2048);
+          out += "  out.append(" + cpp_quote(piece) + ", " + std::to_string(piece.size()) + ");\n";
+        }
+      }
+    }
+    out += "}\n\n";
+  }
+
+  out += "struct plan_entry {\n  const char *extension;\n  size_t length;\n  render_function render;\n};\n\n";
+  out += "// Sorted by extension for binary search.\n";
+  out += "constexpr plan_entry plans[] = {\n";
+  for (size_t i = 0; i + 1 < extensions.size(); i++) {
+    out += "  {" + cpp_quote(extensions[i]) + ", " + std::to_string(extensions[i].size()) + ", render_" +
+           std::to_string(i) + "},\n";
+  }
+  out += "};\n\n";
+  out += "constexpr size_t plan_count = " + std::to_string(extensions.size() - 1) + ";\n";
+  out += "constexpr render_function default_plan = render_" + std::to_string(extensions.size() - 1) + ";\n\n";
+  out += "/**\n * @brief Returns the render function of an extension.\n */\n";
+  out += "inline render_function find_plan(const std::string &extension) {\n";
+  out += "  size_t low = 0;\n  size_t high = plan_count;\n";
+  out += "  while (low < high) {\n";
+  out += "    size_t middle = low + (high - low) / 2;\n";
+  out += "    const plan_entry &entry = plans[middle];\n";
+  out += "    size_t common = entry.length < extension.size() ? entry.length : extension.size();\n";
+  out += "    int order = memcmp(entry.extension, extension.data(), common);\n";
+  out += "    if (order == 0) order = (entry.length < extension.size()) ? -1 : (entry.length > extension.size());\n";
+  out += "    if (order == 0) return entry.render;\n";
+  out += "    if (order < 0) low = middle + 1;\n    else high = middle;\n";
+  out += "  }\n  return default_plan;\n}\n\n";
+  out += "} // namespace generated_templates\n";
+  return write_stdout(out) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief Compresses a buffer in the LZ4 block format, for emit_licenses().
+ *
+ * A hash chain finds the longest earlier match for every position, so text repeated
+ * anywhere in the input (e.g. a disclaimer shared by several licenses) is stored once.
+ * Speed doesn't matter here, the output is compiled into touch.
+ */
+std::string lz4_compress(const std::string &in) {
+  const size_t n = in.size();
+  const size_t max_chain = 1024;
+  std::string out;
+  std::vector<long long> head(1 << 16, -1);
+  std::vector<long long> previous(n, -1);
+  auto hash = [&](size_t pos) {
+    uint32_t value;
+    memcpy(&value, in.data() + pos, 4);
+    return (value * 2654435761u) >> 16;
+  };
+  auto insert = [&](size_t pos) {
+    unsigned h = hash(pos);
+    previous[pos] = head[h];
+    head[h] = (long long)pos;
+  };
+  auto put_length = [&](size_t length) {
+    for (; length >= 255; length -= 255) out += (char)255;
+    out += (char)length;
+  };
+  auto put_sequence = [&](size_t literal_start, size_t literal_length, size_t offset, size_t match_length) {
+    size_t extra = match_length - 4;
+    out += (char)((std::min<size_t>(literal_length, 15) << 4) | (match_length ? std::min<size_t>(extra, 15) : 0));
+    if (literal_length >= 15) put_length(literal_length - 15);
+    out.append(in, literal_start, literal_length);
+    if (match_length == 0) return;
+    out += (char)(offset & 0xFF);
+    out += (char)(offset >> 8);
+    if (extra >= 15) put_length(extra - 15);
+  };
+
+  // The format wants the last match to start 12 bytes before the end and the last 5
+  // bytes to be literals.
+  size_t match_limit = (n > 12) ? n - 12 : 0;
+  size_t anchor = 0;
+  size_t pos = 0;
+  while (pos < match_limit) {
+    size_t best_length = 0;
+    size_t best_offset = 0;
+    size_t chain = 0;
+    for (long long candidate = head[hash(pos)]; candidate >= 0 && pos - candidate <= 65535 && chain < max_chain;
+         candidate = previous[candidate], chain++) {
+      size_t length = 0;
+      while (pos + length < n - 5 && in[candidate + length] == in[pos + length]) length++;
+      if (length > best_length) {
+        best_length = length;
+        best_offset = pos - (size_t)candidate;
+      }
+    }
+    if (best_length < 4) {
+      insert(pos++);
+      continue;
+    }
+    put_sequence(anchor, pos - anchor, best_offset, best_length);
+    for (size_t end = pos + best_length; pos < end; pos++) {
+      if (pos < match_limit) insert(pos);
+    }
+    anchor = pos;
+  }
+  put_sequence(anchor, n - anchor, 0, 0);
+  return out;
+}
+
+/**
+ * @brief Writes a C++ header with the license texts of a directory to stdout.
+ *
+ * Every FILE.txt in the directory becomes the license with the SPDX identifier FILE.
+ * The texts are concatenated and compressed as a whole, which also stores passages that
+ * several licenses share only once; find_license() decompresses them when a
+ * configuration first uses a license.
+ *
+ * @param directory The directory with the license texts.
+ * @return EXIT_SUCCESS if the header was written.
+ */
+int emit_licenses(const char *directory) {
+  std::vector<std::string> ids;
+  WIN32_FIND_DATAA found;
+  std::string prefix = std::string(directory) + "\\";
+  HANDLE search = FindFirstFileA((prefix + "*.txt").c_str(), &found);
+  if (search == INVALID_HANDLE_VALUE) {
+    ERROR_PRINT("Error: No license texts in %s\n", directory);
+    return EXIT_FAILURE;
+  }
+  do {
+    std::string name = found.cFileName;
+    ids.push_back(name.substr(0, name.size() - 4));
+  } while (FindNextFileA(search, &found));
+  FindClose(search);
+  std::sort(ids.begin(), ids.end());
+
+  std::string texts;
+  std::string table;
+  for (const std::string &id : ids) {
+    std::ifstream file(prefix + id + ".txt", std::ios::binary);
+    if (!file.is_open()) {
+      ERROR_PRINT("Error: Could not open license text %s%s.txt\n", prefix.c_str(), id.c_str());
+      return EXIT_FAILURE;
+    }
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    text.erase(std::remove(text.begin(), text.end(), '\r'), text.end());
+    text.erase(text.find_last_not_of('\n') + 1);
+    table += "  {" + cpp_quote(id) + ", " + std::to_string(texts.size()) + ", " + std::to_string(text.size()) + "},\n";
+    texts += text;
+  }
+  std::string compressed = lz4_compress(texts);
+
+  std::string out;
+  out += "// License texts for the <license:ID> placeholder of the touch command.\n";
+  out += "// Generated by `touch --emit-licenses licenses`, do not edit.\n";
+  out += "#pragma once\n\n#include <cstddef>\n\n";
+  out += "namespace spdx_licenses {\n\n";
+  out += "struct license_entry {\n  const char *id;\n  size_t offset;\n  size_t length;\n};\n\n";
+  out += "// Offsets and lengths are in the decompressed texts.\n";
+  out += "constexpr license_entry licenses[] = {\n" + table + "};\n\n";
+  out += "constexpr size_t license_count = " + std::to_string(ids.size()) + ";\n";
+  out += "constexpr size_t text_size = " + std::to_string(texts.size()) + ";\n\n";
+  out += "// Every text, concatenated and compressed in the LZ4 block format.\n";
+  out += "constexpr unsigned char compressed[] = {";
+  for (size_t i = 0; i < compressed.size(); i++) {
+    char byte[16];
+    snprintf(byte, sizeof(byte), "%s0x%02x,", (i % 16 == 0) ? "\n  " : " ", (unsigned char)compressed[i]);
+    out += byte;
+  }
+  out += "\n};\n\n";
+  out += "constexpr size_t compressed_size = sizeof(compressed);\n\n";
+  out += "} // namespace spdx_licenses\n";
+  return write_stdout(out) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief Returns the cache file for a version of a configuration file.
+ *
+ * The name contains a hash of the configuration path and one of its stamp, so a changed
+ * configuration gets a new cache file instead of replacing one that other processes may
+ * have mapped.
+ *
+ * @param directory The cache directory, ending in a path separator.
+ * @param config_path The configuration file.
+ * @param stamp The version of the configuration file.
+ * @param pattern If not null, set to a wildcard matching the caches of every version.
+ */
+std::string config_cache_path(const std::string &directory, const std::string &config_path,
+                              const config_stamp &stamp, std::string *pattern = nullptr) {
+  char path_hash[17];
+  char stamp_hash[17];
+  snprintf(path_hash, sizeof(path_hash), "%016llx", fnv1a_hash(config_path.data(), config_path.size()));
+  unsigned long long version = CONFIG_CACHE_VERSION;
+  unsigned long long hash = fnv1a_hash(&stamp, sizeof(stamp), fnv1a_hash(&version, sizeof(version)));
+  snprintf(stamp_hash, sizeof(stamp_hash), "%016llx", hash);
+  if (pattern != nullptr) {
+    *pattern = directory + "touch-" + path_hash + "-*.cfgc";
+  }
+  return directory + "touch-" + path_hash + "-" + stamp_hash + ".cfgc";
+}
+
+/**
+ * @brief Loads the configuration from a cache file, if it exists and is current.
+ *
+ * The file is mapped read-only and rendered from in place, so concurrent invocations
+ * share its pages and none of them builds a private copy. The view stays mapped until
+ * the configuration is loaded again or the process exits.
+ *
+ * @return True if the configuration was loaded from the cache.
+ */
+bool load_config_cache(const std::string &cache_path, const config_stamp &stamp) {
+  HANDLE file = CreateFileA(cache_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) return false;
+  // The size of a mapped view isn't known up front, so the header is read first and
+  // the payload size is checked against the file size it was published with.
+  LARGE_INTEGER size;
+  bool ok = GetFileSizeEx(file, &size) != 0;
+  unsigned long long file_size = ok ? (unsigned long long)size.QuadPart : 0;
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(file);
+  if (mapping == NULL) return false;
+  const char *view = (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (view == nullptr) return false;
+
+  config_cache_header header;
+  ok = ok && file_size >= sizeof(header);
+  if (ok) {
+    memcpy(&header, view, sizeof(header));
+    ok = memcmp(header.magic, "TOUCHCC", 8) == 0 && header.version == CONFIG_CACHE_VERSION &&
+         header.stamp.size == stamp.size && header.stamp.mtime == stamp.mtime &&
+         header.payload_size == file_size - sizeof(header);
+  }
+  ok = ok && compiled_config.attach(view + sizeof(header), (size_t)header.payload_size);
+  if (!ok) {
+    UnmapViewOfFile(view);
+    return false;
+  }
+  replace_config_cache_view(view);
+  return true;
+}
+
+/**
+ * @brief Publishes the compiled configuration as a cache file and removes stale caches.
+ *
+ * The cache is written to a temporary file and renamed into place, so readers never see
+ * a partial file. A damaged cache of the same version is replaced; if it is mapped by
+ * another process the rename fails and the configuration is simply parsed next time too.
+ */
+void publish_config_cache(const std::string &cache_path, const std::string &stale_pattern, const config_stamp &stamp) {
+  const std::string &payload = compiled_config_storage;
+  config_cache_header header = {};
+  memcpy(header.magic, "TOUCHCC", 8);
+  header.version = CONFIG_CACHE_VERSION;
+  header.stamp = stamp;
+  header.payload_size = payload.size();
+
+  std::string temp_path = cache_path + "." + std::to_string(GetCurrentProcessId()) + ".tmp";
+  HANDLE file = CreateFileA(temp_path.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) return;
+  DWORD written = 0;
+  bool ok = WriteFile(file, &header, sizeof(header), &written, NULL) && written == sizeof(header) &&
+            WriteFile(file, payload.data(), (DWORD)payload.size(), &written, NULL) && written == payload.size();
+  CloseHandle(file);
+  if (!ok || !MoveFileExA(temp_path.c_str(), cache_path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+    DeleteFileA(temp_path.c_str());
+    return;
+  }
+
+  // Caches of older versions may still be mapped by running processes, in which case
+  // deleting them fails and is retried by the next process that publishes a cache.
+  std::string directory = cache_path.substr(0, cache_path.find_last_of("\\/") + 1);
+  std::string current = cache_path.substr(directory.size());
+  WIN32_FIND_DATAA found;
+  HANDLE search = FindFirstFileA(stale_pattern.c_str(), &found);
+  if (search == INVALID_HANDLE_VALUE) return;
+  do {
+    if (current != found.cFileName) {
+      DeleteFileA((directory + found.cFileName).c_str());
+    }
+  } while (FindNextFileA(search, &found));
+  FindClose(search);
+}
+
+/**
+ * @brief The result of looking for the configuration file.
+ */
+struct config_probe {
+  std::string path;   /**< The configuration file next to the executable. */
+  bool exists;
+  config_stamp stamp; /**< The version of the file, if it exists. */
+};
+
+/**
+ * @brief Looks for the configuration file with a single stat, once per process.
+ * @param refresh True to look again, e.g. because the configuration is reloaded.
+ */
+const config_probe &probe_config(bool refresh = false) {
+  static config_probe probe;
+  static bool probed = false;
+  if (probed && !refresh) return probe;
+  probed = true;
+  probe.path = get_config_path();
+  WIN32_FILE_ATTRIBUTE_DATA data;
+  probe.exists = GetFileAttributesExA(probe.path.c_str(), GetFileExInfoStandard, &data) != 0;
+  probe.stamp.size = probe.exists ? ((unsigned long long)data.nFileSizeHigh << 32) | data.nFileSizeLow : 0;
+  probe.stamp.mtime = probe.exists ?
+    ((unsigned long long)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime : 0;
+  return probe;
+}
+
+/**
+ * @brief Loads the configuration, from the compiled cache if possible.
+ *
+ * Without a configuration file the built-in templates are used, so touch works out of
+ * the box and nothing has to be opened. With one, an external configuration always
+ * overrides the built-in templates.
+ *
+ * When many invocations run at once (e.g. from a parallel build) only the first one
+ * parses the configuration file; it publishes the result in the temporary directory and
+ * the others map it instead of parsing. The cache is stamped with the size and write
+ * time of the configuration file, so an edited configuration is parsed again. Loading
+ * also forgets the CODEOWNERS files read so far, so a reload reads them again.
+ *
+ * @param probe The configuration file, as found by probe_config().
+ * @param use_cache False to always parse the configuration file.
+ */
+void load_config(const config_probe &probe, bool use_cache) {
+  reset_owners();
+  variable_map.clear();
+  plugin_map.clear();
+  type_options_map.clear();
+  type_raw_map.clear();
+  type_settings_map.clear();
+  use_generated_templates = !probe.exists;
+  if (!probe.exists) {
+    replace_config_cache_view(nullptr);
+    return;
+  }
+  char temp_directory[MAX_PATH + 1];
+  bool cacheable = use_cache && GetTempPathA(sizeof(temp_directory), temp_directory) != 0;
+  std::string stale_pattern;
+  std::string cache_path;
+  bool cached = false;
+  {
+    // One config load per call, whether the cache was mapped, missed or not used.
+    phase_timer timer(PHASE_CONFIG_LOAD);
+    if (cacheable) {
+      cache_path = config_cache_path(temp_directory, probe.path, probe.stamp, &stale_pattern);
+      cached = load_config_cache(cache_path, probe.stamp);
+    }
+    if (!cached) {
+      parse_config_file(probe.path.c_str());
+    }
+  }
+  TRACE_POINT("ConfigLoad", TraceLoggingString(probe.path.c_str(), "Path"),
+              TraceLoggingUInt64(probe.stamp.size, "Bytes"), TraceLoggingBool(cached, "Cached"));
+  if (cached) {
+    DEBUG_PRINT("Loaded configuration from %s\n", cache_path.c_str());
+    service_stats.config_cache_hits.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  use_parsed_config();
+  if (cacheable) {
+    service_stats.config_cache_misses.fetch_add(1, std::memory_order_relaxed);
+    publish_config_cache(cache_path, stale_pattern, probe.stamp);
+  }
+}
+
+/**
+ * @brief Prints help information to the console.
+ *
+ * This function outputs usage instructions, available command-line options,
+ * and repository information for the touch command.
+ */
+void print_help() {
+  INFO_PRINT("Usage: touch FILE...\n");
+  INFO_PRINT("Customize the touch command using the configuration file %s\n", get_config_path().c_str());
+  INFO_PRINT("\nOptions:\n");
+  INFO_PRINT("  --version             Display version information\n");
+  INFO_PRINT("  --help                Display this help message\n");
+  INFO_PRINT("  --fs=native|memory    Select the filesystem backend (memory is for benchmarking)\n");
+  INFO_PRINT("  --fs-latency=META_US[,WRITE_US[,BYTES_PER_US[,CHANNELS[,DIR_LOCK_US]]]]\n");
+  INFO_PRINT("                        Simulated latency for the memory backend\n");
+  INFO_PRINT("  --output-tar=FILE|-   Write the files into a tar archive (or to stdout) instead of the disk\n");
+  INFO_PRINT("  -j N|auto, --jobs=N|auto\n");
+  INFO_PRINT("                        Create files with N workers, or adapt the number to the storage\n");
+  INFO_PRINT("  --files-from=FILE|-   Read additional file names, one per line, from FILE or stdin\n");
+  INFO_PRINT("  --timings[=hw]        Print throughput and pipeline statistics to stderr; with hw also\n");
+  INFO_PRINT("                        cycles and page faults of the config load, compile, render and\n");
+  INFO_PRINT("                        write phases\n");
+  INFO_PRINT("  -p, --parents         Create missing parent directories\n");
+  INFO_PRINT("  --async[=N]           Create files as coroutines on a few threads, up to N (%d) in flight;\n", ASYNC_DEFAULT_IN_FLIGHT);
+  INFO_PRINT("                        with -j auto the number in flight adapts up to N\n");
+  INFO_PRINT("  --transaction[=JOURNAL]\n");
+  INFO_PRINT("                        Undo every change if any file fails, keeping an undo journal in\n");
+  INFO_PRINT("                        JOURNAL (%s) and originals of overwritten files in JOURNAL.d\n", DEFAULT_JOURNAL);
+  INFO_PRINT("  --rollback=JOURNAL    Undo an interrupted transaction, run from the same directory\n");
+  INFO_PRINT("  --size=N[K|M|G]       Fill every file up to N bytes after its header, for test fixtures\n");
+  INFO_PRINT("  --fill=zero|random|pattern|sparse\n");
+  INFO_PRINT("                        How --size fills the files (zero); pattern repeats the bytes\n");
+  INFO_PRINT("                        0 to 255, sparse leaves the zeros unallocated where possible\n");
+  INFO_PRINT("  --manifest=FILE|-     Write the SHA-256 checksum of every created file to FILE (or stdout),\n");
+  INFO_PRINT("                        in the format of sha256sum\n");
+  INFO_PRINT("  --counter=FILE        Continue the numbers of <seq> from FILE and save the next one to it\n");
+  INFO_PRINT("  --stdout              Write the rendered messages to stdout instead of creating the files\n");
+  INFO_PRINT("  --no-config-cache     Always parse the configuration file instead of using the compiled\n");
+  INFO_PRINT("                        copy cached in the temporary directory\n");
+  INFO_PRINT("  --trace               Publish the tracepoints of the WinDevTools.Touch ETW provider\n");
+  INFO_PRINT("  --emit-cpp CONFIG     Write C++ render functions for CONFIG to stdout, to build a touch\n");
+  INFO_PRINT("                        with a built-in configuration (see README.md)\n");
+  INFO_PRINT("  --emit-licenses DIR   Write the license texts in DIR to stdout as a C++ header, to\n");
+  INFO_PRINT("                        rebuild touch with them (see README.md)\n");
+  INFO_PRINT("  --bench-startup=N [FILE]\n");
+  INFO_PRINT("                        Time N runs of touch FILE (cold-start.c) from start to exit, with\n");
+  INFO_PRINT("                        the other options given, and print percentiles\n");
+  INFO_PRINT("  --serve-stdio         Answer JSON-lines render requests on stdin until it ends, e.g.\n");
+  INFO_PRINT("                        {\"id\": 1, \"method\": \"render\", \"file\": \"main.c\"}\n");
+  INFO_PRINT("  --serve-pipe[=NAME]   Answer pipelined binary requests on the named pipe NAME (touch)\n");
+  INFO_PRINT("                        until Ctrl+C, with -j workers (one per processor)\n\n");
+  INFO_PRINT("touch.exe is a private non-commercial project bundled with win_dev_tools by Gustav Pettersson Björklund.\n");
+  INFO_PRINT("This program comes with NO WARRANTY. If you are missing some functionality feel free to contribute :D \n");
+  INFO_PRINT("For feature requests or issues, please create an issue on the GitHub repository:\n");
+  INFO_PRINT("https://github.com/GustavPetterssonBjorklund/win_dev_tools\n");
+}
+
+/**
+ * @brief Prompts the user for confirmation before performing an action.
+ *
+ * This function displays a prompt asking whether the user wants to perform
+ * a specific action. The user must enter a confirmation phrase to proceed.
+ *
+ * @param action A description of the action that requires confirmation.
+ * @param confirmation_type_phrase The phrase the user must type to confirm.
+ * @return True if the user confirms the action, false otherwise.
+ */
+bool confirm_action(const char* action, const char* confirmation_type_phrase) {
+  INFO_PRINT("Do you want to %s? [y/N] ", action);
+  // Anything unreadable, including the end of stdin, is a no.
+  char response = 'n';
+  if (scanf_s(" %c", &response, 1) != 1) {
+    return false;
+  }
+  if (response == 'y' || response == 'Y') {
+    INFO_PRINT("Please type \"%s\" to confirm that you want to %s: ", confirmation_type_phrase, action);
+    char confirmation[100] = "";
+    if (scanf_s("%99s", confirmation, (unsigned)sizeof(confirmation)) != 1) {
+      return false;
+    }
+    return (strcmp(confirmation, confirmation_type_phrase) == 0);
+  }
+  return false;
+}
+
+/**
+ * @brief Renders the message written to a newly created file.
+ *
+ * The message is produced by the render plan compiled for the file extension (see
+ * build_render_plan()), which only has to fill in the file name and the date.
+ *
+ * @param filename The name of the target file, used for the "<file>" option.
+ * @param file_extension The extension of the target file, including the dot.
+ * @return The complete file content.
+ */
+std::string render_file_message(const std::string &filename, const std::string &file_extension) {
+  phase_timer timer(PHASE_RENDER);
+  TRACE_POINT("RenderStart", TraceLoggingString(filename.c_str(), "Path"));
+  render_values values(filename);
+  std::string message;
+  if (use_generated_templates) {
+    generated_templates::find_plan(file_extension)(message, filename, render_values::callback, &values);
+  }
+  else {
+    message = compiled_config.render(filename, file_extension, values);
+  }
+  TRACE_POINT("RenderEnd", TraceLoggingString(filename.c_str(), "Path"), TraceLoggingUInt64(message.size(), "Bytes"));
+  return message;
+}
+
+/**
+ * @brief Creates a directory and all of its missing parents, like mkdir -p.
+ *
+ * @param fs The filesystem backend to create the directories with.
+ * @param directory The directory to create. An empty string names the current directory.
+ * @return True if the directory exists afterwards.
+ */
+bool make_parents(filesystem &fs, const std::string &directory) {
+  if (directory.empty()) return true;
+  file_stat existing;
+  if (fs.stat(directory, &existing)) {
+    return existing.is_directory;
+  }
+  std::string parent = split_parent(directory);
+  if (parent != directory && !make_parents(fs, parent)) {
+    return false;
+  }
+  // Another worker may have created the directory in the meantime.
+  return fs.mkdir(directory) || (fs.stat(directory, &existing) && existing.is_directory);
+}
+
+/**
+ * @brief Returns the extension of a file name including the dot, or an empty string.
+ */
+std::string get_file_extension(const std::string &filename) {
+  size_t dot_pos = filename.find_last_of(".");
+  return (dot_pos != std::string::npos) ? filename.substr(dot_pos) : "";
+}
+
+/**
+ * @brief How the payload of --size is filled.
+ */
+enum fill_mode {
+  FILL_ZERO,    /**< Zeros, allocated without writing them. */
+  FILL_RANDOM,  /**< Pseudo-random bytes. */
+  FILL_PATTERN, /**< The byte values 0 to 255, repeated. */
+  FILL_SPARSE   /**< Zeros, left unallocated where the file system supports it. */
+};
+
+/**
+ * @brief Payload appended to every created file, for generating test fixtures.
+ */
+struct payload_options {
+  unsigned long long size = 0; /**< Size of the whole file, 0 for no payload. */
+  fill_mode fill = FILL_ZERO;
+};
+
+/**
+ * @brief Parses a size of the form N[K|M|G], in bytes or binary multiples of them.
+ * @return True if the size is valid.
+ */
+bool parse_size(const char *text, unsigned long long *out) {
+  char *end = nullptr;
+  unsigned long long value = strtoull(text, &end, 10);
+  if (end == text) return false;
+  unsigned shift = 0;
+  switch (*end) {
+    case 'K': case 'k': shift = 10; end++; break;
+    case 'M': case 'm': shift = 20; end++; break;
+    case 'G': case 'g': shift = 30; end++; break;
+  }
+  if (*end != '\0' || value > (~0ULL >> shift)) return false;
+  *out = value << shift;
+  return true;
+}
+
+/**
+ * @brief Parses the name of a fill mode.
+ * @return True if the name is known.
+ */
+bool parse_fill_mode(const char *name, fill_mode *out) {
+  static const std::pair<const char *, fill_mode> modes[] = {
+    {"zero", FILL_ZERO}, {"random", FILL_RANDOM}, {"pattern", FILL_PATTERN}, {"sparse", FILL_SPARSE}
+  };
+  for (const auto &mode : modes) {
+    if (strcmp(name, mode.first) == 0) {
+      *out = mode.second;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Pseudo-random generator for --fill=random: xoshiro256+ on several independent
+ * lanes.
+ *
+ * Each lane is a separate generator, stored as a structure of arrays, so the compiler
+ * turns the inner loop into vector instructions and a block is filled at several bytes
+ * per cycle. The output is meant for test data, not for anything security related.
+ */
+class random_fill {
+public:
+  random_fill() {
+    // Every generator gets its own seed, even within the same clock tick.
+    static std::atomic<unsigned long long> generators(0);
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    unsigned long long seed = (unsigned long long)counter.QuadPart ^ ((unsigned long long)GetCurrentProcessId() << 32) ^
+                              (++generators * 0x9e3779b97f4a7c15ULL);
+    for (int lane = 0; lane < LANES; lane++) {
+      s0[lane] = split_mix(&seed);
+      s1[lane] = split_mix(&seed);
+      s2[lane] = split_mix(&seed);
+      s3[lane] = split_mix(&seed);
+    }
+  }
+
+  /**
+   * @brief Fills words with random values. words has to be a multiple of LANES.
+   */
+  void fill(unsigned long long *out, size_t words) {
+    for (size_t i = 0; i < words; i += LANES) {
+      for (int lane = 0; lane < LANES; lane++) {
+        out[i + lane] = s0[lane] + s3[lane];
+        unsigned long long t = s1[lane] << 17;
+        s2[lane] ^= s0[lane];
+        s3[lane] ^= s1[lane];
+        s1[lane] ^= s2[lane];
+        s0[lane] ^= s3[lane];
+        s2[lane] ^= t;
+        s3[lane] = (s3[lane] << 45) | (s3[lane] >> 19);
+      }
+    }
+  }
+
+  static const int LANES = 8;
+
+private:
+  static unsigned long long split_mix(unsigned long long *state) {
+    unsigned long long z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  unsigned long long s0[LANES], s1[LANES], s2[LANES], s3[LANES];
+};
+
+/**
+ * @brief A block of FILL_BLOCK_SIZE bytes of --fill=pattern that stays valid for the whole run.
+ *
+ * The pattern repeats every 256 bytes, so consecutive blocks continue it seamlessly.
+ */
+const char *pattern_fill_block() {
+  static const std::vector<char> block = []() {
+    std::vector<char> pattern(FILL_BLOCK_SIZE);
+    for (size_t i = 0; i < pattern.size(); i++) {
+      pattern[i] = (char)(unsigned char)i;
+    }
+    return pattern;
+  }();
+  return block.data();
+}
+
+/**
+ * @brief Appends a payload to a file opened with create().
+ *
+ * Zero and sparse payloads only move the end of the file. Pattern payloads are written
+ * from one shared block, and random payloads are generated a block at a time into a
+ * buffer of the calling thread, so memory use doesn't grow with the size of the files.
+ *
+ * @param fs The filesystem backend the file was created with.
+ * @param file The file, after its rendered message has been written.
+ * @param size The number of bytes to append.
+ * @param fill How to fill them.
+ * @return True if the whole payload was written.
+ */
+bool write_payload(filesystem &fs, fs_handle file, unsigned long long size, fill_mode fill) {
+  if (fill == FILL_ZERO || fill == FILL_SPARSE) {
+    return fs.extend(file, size, fill == FILL_SPARSE);
+  }
+  static thread_local random_fill generator;
+  static thread_local std::vector<unsigned long long> random_block;
+  while (size > 0) {
+    size_t chunk = (size_t)std::min<unsigned long long>(size, FILL_BLOCK_SIZE);
+    bool written;
+    if (fill == FILL_PATTERN) {
+      written = fs.write(file, pattern_fill_block(), chunk);
+    }
+    else {
+      random_block.resize(FILL_BLOCK_SIZE / sizeof(unsigned long long));
+      size_t words = (chunk + sizeof(unsigned long long) - 1) / sizeof(unsigned long long);
+      generator.fill(random_block.data(), (words + random_fill::LANES - 1) / random_fill::LANES * random_fill::LANES);
+      written = fs.write_transient(file, (const char *)random_block.data(), chunk);
+    }
+    if (!written) return false;
+    size -= chunk;
+  }
+  return true;
+}
+
+/**
+ * @brief Creates (or truncates) a file and writes an already rendered message to it.
+ *
+ * @param fs The filesystem backend to create the file with.
+ * @param filename The path of the file to create.
+ * @param file_message The content of the file. It has to outlive the call, since backends
+ *                     may write it lazily on close.
+ * @param directory If not null, the parent directory of the file opened with open_dir().
+ * @param payload Payload to append after the message, see --size.
+ * @return True if the file was created and written.
+ */
+bool write_file(filesystem &fs, const std::string &filename, const std::string &file_message,
+                fs_handle directory = nullptr, const payload_options &payload = payload_options()) {
+  phase_timer timer(PHASE_WRITE);
+  DEBUG_PRINT("Creating file: %s\n", filename.c_str());
+  fs_handle file;
+  if (directory != nullptr) {
+    std::string name;
+    split_parent(filename, &name);
+    file = fs.create_at(directory, name);
+  }
+  else {
+    file = fs.create(filename);
+  }
+  TRACE_POINT("FileOpen", TraceLoggingString(filename.c_str(), "Path"), TraceLoggingBool(file != nullptr, "Ok"));
+  if (file == nullptr) {
+    ERROR_PRINT("Error: Could not create file %s\n", filename.c_str());
+    return false;
+  }
+  bool written = fs.write(file, file_message.data(), file_message.size());
+  if (written && payload.size > file_message.size()) {
+    written = write_payload(fs, file, payload.size - file_message.size(), payload.fill);
+  }
+  TRACE_POINT("FileWrite", TraceLoggingString(filename.c_str(), "Path"),
+              TraceLoggingUInt64(std::max<unsigned long long>(file_message.size(), payload.size), "Bytes"),
+              TraceLoggingBool(written, "Ok"));
+  bool closed = fs.close(file);
+  TRACE_POINT("FileClose", TraceLoggingString(filename.c_str(), "Path"), TraceLoggingBool(closed, "Ok"));
+  if (!closed || !written) {
+    ERROR_PRINT("Error: Could not write to file %s\n", filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief The outcome of create_file().
+ */
+enum create_result {
+  CREATE_FAILED,  /**< The file could not be created or written. */
+  CREATE_DONE,    /**< The file was created and written. */
+  CREATE_SKIPPED  /**< The file exists and the user declined to overwrite it. */
+};
+
+/**
+ * @brief Creates a single file and writes its rendered message.
+ *
+ * If the file already exists the user is asked for confirmation before it is overwritten.
+ * A declined overwrite is not a failure: it leaves the file alone and doesn't roll back
+ * a transaction.
+ *
+ * @param fs The filesystem backend to create the file with.
+ * @param filename The path of the file to create.
+ * @param parents True to create missing parent directories.
+ * @param payload Payload to append after the message, see --size.
+ * @return Whether the file was created, skipped or failed.
+ */
+create_result create_file(filesystem &fs, const std::string &filename, bool parents = false,
+                          const payload_options &payload = payload_options()) {
+  if (parents && !make_parents(fs, split_parent(filename))) {
+    ERROR_PRINT("Error: Could not create directory for %s\n", filename.c_str());
+    return CREATE_FAILED;
+  }
+  // Check if file exists.
+  file_stat existing;
+  if (fs.stat(filename, &existing)) {
+    ERROR_PRINT("Error: File %s already exists\n", filename.c_str());
+    if (stdin_file_list) {
+      // The answer would be read from the file list.
+      ERROR_PRINT("Error: Can't confirm the overwrite, stdin holds the file list (--files-from=-)\n");
+      return CREATE_FAILED;
+    }
+    if (!confirm_action("overwrite the file", "overwrite")) {
+      INFO_PRINT("Aborting file creation...\n");
+      return CREATE_SKIPPED;
+    }
+  }
+  std::string file_extension = get_file_extension(filename);
+  DEBUG_PRINT("Creating file of type %s: %s\n", file_extension.c_str(), filename.c_str());
+  std::string file_message = render_file_message(filename, file_extension);
+  return write_file(fs, filename, file_message, nullptr, payload) ? CREATE_DONE : CREATE_FAILED;
+}
+
+/**
+ * @brief Adaptive limit on the number of file operations in flight during a batch.
+ *
+ * The controller samples the completion rate and the mean latency of the operations
+ * finished in each window and adjusts the limit in AIMD fashion:
+ * - while more concurrency keeps buying throughput the limit grows, doubling until the
+ *   first back-off and by one afterwards;
+ * - if the last increase did not raise throughput, or the latency has more than doubled
+ *   compared to the best latency seen (requests are queueing in the device or in a
+ *   lock), the limit shrinks multiplicatively.
+ *
+ * record() is called by the workers and only touches atomics, tick() is called
+ * periodically by a single control thread.
+ */
+class concurrency_controller {
+public:
+  concurrency_controller(unsigned min_limit, unsigned max_limit)
+    : min_limit(min_limit), max_limit(max_limit), current_limit(min_limit),
+      completions(0), latency_total_us(0), window_start(std::chrono::steady_clock::now()),
+      slow_start(true), last_rate(0), last_limit(0), min_latency_us(0),
+      lowest_limit(min_limit), highest_limit(min_limit), adjustments(0) {}
+
+  /**
+   * @brief The number of operations currently allowed in flight.
+   */
+  unsigned limit() const {
+    return current_limit.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Records a finished operation.
+   * @param latency_us The time the operation took in microseconds.
+   */
+  void record(unsigned long long latency_us) {
+    completions.fetch_add(1, std::memory_order_relaxed);
+    latency_total_us.fetch_add(latency_us, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Re-evaluates the limit once enough operations have completed.
+   * @return True if the limit was raised and parked workers should be woken.
+   */
+  bool tick() {
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - window_start).count();
+    unsigned long long done = completions.load(std::memory_order_relaxed);
+    unsigned limit = current_limit.load(std::memory_order_relaxed);
+
+    // Small windows are too noisy to compare, wait for a few completions per slot.
+    if (elapsed < MIN_WINDOW_SECONDS || (done < 2ULL * limit && elapsed < MAX_WINDOW_SECONDS)) {
+      return false;
+    }
+    done = completions.exchange(0, std::memory_order_relaxed);
+    unsigned long long latency_total = latency_total_us.exchange(0, std::memory_order_relaxed);
+    window_start = now;
+    if (done == 0) {
+      return false;
+    }
+
+    double rate = done / elapsed;
+    double latency = (double)latency_total / done;
+    if (min_latency_us == 0 || latency < min_latency_us) {
+      min_latency_us = latency;
+    }
+
+    unsigned next;
+    if (latency > 2 * min_latency_us) {
+      next = limit * 3 / 4;
+      slow_start = false;
+    }
+    else if (last_limit != 0 && limit > last_limit && rate < last_rate * 1.05) {
+      next = limit - std::max(1u, limit / 8);
+      slow_start = false;
+    }
+    else {
+      next = slow_start ? limit * 2 : limit + 1;
+    }
+    next = std::max(min_limit, std::min(max_limit, next));
+
+    last_rate = rate;
+    last_limit = limit;
+    if (next != limit) {
+      current_limit.store(next, std::memory_order_relaxed);
+      lowest_limit = std::min(lowest_limit, next);
+      highest_limit = std::max(highest_limit, next);
+      adjustments++;
+    }
+    return next > limit;
+  }
+
+  /**
+   * @brief Prints a summary of the controller's decisions for --timings.
+   */
+  void print_summary() const {
+    ERROR_PRINT("  concurrency: final %u, range %u-%u, %u adjustments\n",
+                limit(), lowest_limit, highest_limit, adjustments);
+  }
+
+private:
+  static constexpr double MIN_WINDOW_SECONDS = 0.005; /**< Shortest sampling window. */
+  static constexpr double MAX_WINDOW_SECONDS = 0.25;  /**< Longest sampling window. */
+
+  const unsigned min_limit;
+  const unsigned max_limit;
+  std::atomic<unsigned> current_limit;
+  std::atomic<unsigned long long> completions;
+  std::atomic<unsigned long long> latency_total_us;
+
+  // Only used by the control thread.
+  std::chrono::steady_clock::time_point window_start;
+  bool slow_start;
+  double last_rate;
+  unsigned last_limit;
+  double min_latency_us;
+  unsigned lowest_limit;
+  unsigned highest_limit;
+  unsigned adjustments;
+};
+
+/**
+ * @brief Settings for creating many files at once.
+ */
+struct batch_options {
+  unsigned jobs = 1;      /**< Number of parallel workers, or the upper bound when adaptive. */
+  bool adaptive = false;  /**< Let a concurrency_controller pick the number of workers. */
+  bool timings = false;   /**< Print throughput and pipeline statistics to stderr. */
+  bool parents = false;   /**< Create missing parent directories. */
+  unsigned async_in_flight = 0; /**< Operations in flight for the asynchronous I/O stage, 0 to use threads. */
+  payload_options payload;      /**< Payload appended to every file. */
+};
+
+/**
+ * @brief A source of target file names: a name given on the command line or a list file.
+ */
+struct batch_input {
+  std::string value; /**< The file name, or the path of the list ("-" for stdin). */
+  bool is_list;      /**< True if value names a list of file names. */
+};
+
+/**
+ * @brief Reads a line of any length from a stream, without its line break.
+ * @return False at the end of the stream.
+ */
+bool read_line(FILE *in, std::string *line) {
+  char buffer[4096];
+  line->clear();
+  while (fgets(buffer, sizeof(buffer), in) != nullptr) {
+    *line += buffer;
+    if (line->back() == '\n') break;
+  }
+  if (line->empty()) return false;
+  line->erase(line->find_last_not_of("\r\n") + 1);
+  return true;
+}
+
+/**
+ * @brief Feeds every target named by the inputs to a callback, in order.
+ *
+ * List files are streamed line by line, so arbitrarily long lists are never held in
+ * memory as a whole.
+ *
+ * @param inputs The command-line names and list files.
+ * @param callback Called with each file name.
+ * @return True if every list could be read.
+ */
+template <typename Callback>
+bool for_each_target(const std::vector<batch_input> &inputs, Callback callback) {
+  bool ok = true;
+  for (const batch_input &input : inputs) {
+    if (!input.is_list) {
+      callback(input.value);
+      continue;
+    }
+    FILE *list = stdin;
+    if (input.value != "-" && (fopen_s(&list, input.value.c_str(), "r") != 0 || list == nullptr)) {
+      ERROR_PRINT("Error: Could not read file list %s\n", input.value.c_str());
+      ok = false;
+      continue;
+    }
+    std::string line;
+    while (read_line(list, &line)) {
+      if (!line.empty()) {
+        callback(line);
+      }
+    }
+    if (list != stdin) {
+      fclose(list);
+    }
+  }
+  return ok;
+}
+
+/**
+ * @brief Bounded lock-free queue for one producer and one consumer thread.
+ *
+ * The classic ring buffer: each side owns one index and caches the other side's index,
+ * so the shared cache lines are only touched when the cached value runs out.
+ */
+template <typename T>
+class spsc_queue {
+public:
+  explicit spsc_queue(size_t min_capacity) : capacity(round_up_pow2(min_capacity)), slots(capacity),
+                                             head(0), tail(0), cached_head(0), cached_tail(0) {}
+
+  bool try_push(const T &value) {
+    size_t position = tail.load(std::memory_order_relaxed);
+    if (position - cached_head >= capacity) {
+      cached_head = head.load(std::memory_order_acquire);
+      if (position - cached_head >= capacity) return false;
+    }
+    slots[position & (capacity - 1)] = value;
+    tail.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool try_pop(T *out) {
+    size_t position = head.load(std::memory_order_relaxed);
+    if (position == cached_tail) {
+      cached_tail = tail.load(std::memory_order_acquire);
+      if (position == cached_tail) return false;
+    }
+    *out = slots[position & (capacity - 1)];
+    head.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief The approximate number of queued elements.
+   */
+  size_t size() const {
+    return tail.load(std::memory_order_relaxed) - head.load(std::memory_order_relaxed);
+  }
+
+  const size_t capacity;
+
+private:
+  static size_t round_up_pow2(size_t value) {
+    size_t result = 1;
+    while (result < value) result <<= 1;
+    return result;
+  }
+
+  std::vector<T> slots;
+  alignas(64) std::atomic<size_t> head;
+  alignas(64) std::atomic<size_t> tail;
+  alignas(64) size_t cached_head; /**< Producer's copy of head. */
+  alignas(64) size_t cached_tail; /**< Consumer's copy of tail. */
+};
+
+/**
+ * @brief Bounded lock-free queue for any number of producer and consumer threads.
+ *
+ * Dmitry Vyukov's array queue: every cell carries a sequence number that tells
+ * producers and consumers whether it is free or filled for their lap around the ring,
+ * so each operation costs a single compare-and-swap on the shared position.
+ */
+template <typename T>
+class mpmc_queue {
+public:
+  explicit mpmc_queue(size_t min_capacity) : capacity(round_up_pow2(min_capacity)), cells(new cell[capacity]),
+                                             enqueue_position(0), dequeue_position(0) {
+    for (size_t i = 0; i < capacity; i++) {
+      cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  bool try_push(const T &value) {
+    size_t position = enqueue_position.load(std::memory_order_relaxed);
+    for (;;) {
+      cell &slot = cells[position & (capacity - 1)];
+      size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+      if (difference == 0) {
+        if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          slot.value = value;
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (difference < 0) {
+        return false;
+      }
+      else {
+        position = enqueue_position.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool try_pop(T *out) {
+    size_t position = dequeue_position.load(std::memory_order_relaxed);
+    for (;;) {
+      cell &slot = cells[position & (capacity - 1)];
+      size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+      if (difference == 0) {
+        if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          *out = slot.value;
+          slot.sequence.store(position + capacity, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (difference < 0) {
+        return false;
+      }
+      else {
+        position = dequeue_position.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * @brief The approximate number of queued elements.
+   */
+  size_t size() const {
+    size_t enqueued = enqueue_position.load(std::memory_order_relaxed);
+    size_t dequeued = dequeue_position.load(std::memory_order_relaxed);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+  }
+
+  const size_t capacity;
+
+private:
+  struct cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  static size_t round_up_pow2(size_t value) {
+    size_t result = 1;
+    while (result < value) result <<= 1;
+    return result;
+  }
+
+  std::unique_ptr<cell[]> cells;
+  alignas(64) std::atomic<size_t> enqueue_position;
+  alignas(64) std::atomic<size_t> dequeue_position;
+};
+
+/**
+ * @brief Waits with increasing delays, for threads blocked on a full or empty queue.
+ *
+ * Short waits spin on yield so a busy pipeline hands over quickly; long waits (e.g. on
+ * a slow file system) sleep so they don't burn a core.
+ */
+class backoff {
+public:
+  backoff() : rounds(0) {}
+
+  void wait() {
+    if (rounds < 32) {
+      std::this_thread::yield();
+    }
+    else {
+      sleep_microseconds(rounds < 64 ? 50 : 500);
+    }
+    rounds++;
+  }
+
+private:
+  unsigned rounds;
+};
+
+/**
+ * @brief A bounded queue between two pipeline stages, with blocking and statistics.
+ *
+ * push() blocks while the queue is full, which is how a slow stage exerts backpressure
+ * on the stages before it. pop() blocks while the queue is empty and returns false once
+ * it is empty and every producer has called producer_done().
+ */
+template <typename Queue, typename T>
+class stage_queue {
+public:
+  stage_queue(const char *name, size_t capacity, unsigned producers)
+    : name(name), queue(capacity), open_producers(producers), pushes(0), fill_total(0),
+      fill_max(0), full_stalls(0), empty_stalls(0), full_wait_us(0), empty_wait_us(0) {}
+
+  void push(const T &value) {
+    if (!queue.try_push(value)) {
+      full_stalls.fetch_add(1, std::memory_order_relaxed);
+      auto start = std::chrono::steady_clock::now();
+      backoff waiter;
+      while (!queue.try_push(value)) {
+        waiter.wait();
+      }
+      full_wait_us.fetch_add(elapsed_us(start), std::memory_order_relaxed);
+    }
+    size_t fill = queue.size();
+    pushes.fetch_add(1, std::memory_order_relaxed);
+    fill_total.fetch_add(fill, std::memory_order_relaxed);
+    size_t max = fill_max.load(std::memory_order_relaxed);
+    while (fill > max && !fill_max.compare_exchange_weak(max, fill, std::memory_order_relaxed)) {}
+  }
+
+  bool pop(T *out) {
+    if (queue.try_pop(out)) return true;
+    if (open_producers.load(std::memory_order_acquire) == 0) return queue.try_pop(out);
+    empty_stalls.fetch_add(1, std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    backoff waiter;
+    bool popped;
+    for (;;) {
+      if (queue.try_pop(out)) {
+        popped = true;
+        break;
+      }
+      if (open_producers.load(std::memory_order_acquire) == 0) {
+        popped = queue.try_pop(out);
+        break;
+      }
+      waiter.wait();
+    }
+    empty_wait_us.fetch_add(elapsed_us(start), std::memory_order_relaxed);
+    return popped;
+  }
+
+  /**
+   * @brief True if pop() would not have to wait right now.
+   */
+  bool has_data() const {
+    return queue.size() > 0;
+  }
+
+  /**
+   * @brief Called by each producer when it will not push anymore.
+   */
+  void producer_done() {
+    open_producers.fetch_sub(1, std::memory_order_release);
+  }
+
+  /**
+   * @brief Prints the occupancy and stall counters for --timings.
+   */
+  void print_stats() const {
+    unsigned long long count = pushes.load();
+    ERROR_PRINT("  %-18s %8zu %9.1f %9zu %8llu %9.1f %8llu %9.1f\n", name, queue.capacity,
+                count ? (double)fill_total.load() / count : 0.0, fill_max.load(),
+                full_stalls.load(), full_wait_us.load() / 1000.0,
+                empty_stalls.load(), empty_wait_us.load() / 1000.0);
+  }
+
+private:
+  static unsigned long long elapsed_us(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  const char *name;
+  Queue queue;
+  std::atomic<unsigned> open_producers;
+  std::atomic<unsigned long long> pushes;
+  std::atomic<unsigned long long> fill_total;    /**< Sum of the fill level after each push. */
+  std::atomic<size_t> fill_max;
+  std::atomic<unsigned long long> full_stalls;   /**< Pushes that found the queue full. */
+  std::atomic<unsigned long long> empty_stalls;  /**< Pops that found the queue empty. */
+  std::atomic<unsigned long long> full_wait_us;
+  std::atomic<unsigned long long> empty_wait_us;
+};
+
+/**
+ * @brief A file travelling through the batch pipeline.
+ */
+struct directory_shard;
+
+struct batch_item {
+  std::string filename;
+  std::string extension;   /**< Filled in by the classify stage. */
+  std::string message;     /**< Filled in by the render stage. */
+  directory_shard *shard;  /**< The shard of the parent directory, set by the classify stage. */
+};
+
+/**
+ * @brief The files of a batch in one directory, leased to one I/O worker at a time.
+ *
+ * The classify stage keeps a single shard per directory for the whole batch and the
+ * render stage appends rendered files to it. A shard with files waiting is either in the
+ * render -> I/O queue or leased by a worker, never both, so the files of a directory are
+ * created by one worker at a time, in order. The worker holding the lease keeps taking
+ * the files appended in the meantime and only returns the lease once the shard is empty.
+ */
+struct directory_shard {
+  std::string directory;            /**< The parent directory, empty for the current directory. */
+  std::mutex mutex;
+  std::vector<batch_item *> items;  /**< Rendered files waiting for the I/O stage. */
+  bool scheduled = false;           /**< Queued for the I/O stage or leased by a worker. */
+  bool prepared = false;            /**< Only used by the lease holder: parents were created. */
+  bool prepared_ok = false;         /**< Only used by the lease holder: creating parents worked. */
+
+  /**
+   * @brief Adds a rendered file.
+   * @return True if the shard was idle and has to be queued for the I/O stage now.
+   */
+  bool append(batch_item *item) {
+    std::lock_guard<std::mutex> lock(mutex);
+    items.push_back(item);
+    if (scheduled) return false;
+    scheduled = true;
+    return true;
+  }
+
+  /**
+   * @brief Takes the files waiting, for the lease holder.
+   * @return False, ending the lease, if no file is waiting.
+   */
+  bool take(std::vector<batch_item *> *out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (items.empty()) {
+      scheduled = false;
+      return false;
+    }
+    out->swap(items);
+    return true;
+  }
+
+  /**
+   * @brief Creates the missing parents with -p, once per batch, for the lease holder.
+   * @return False if the directory can't be created.
+   */
+  bool prepare(filesystem &fs, bool parents) {
+    if (!prepared) {
+      prepared_ok = !parents || make_parents(fs, directory);
+      prepared = true;
+    }
+    return prepared_ok;
+  }
+};
+
+#if defined(__cpp_impl_coroutine)
+/**
+ * @brief Return type of the coroutines of the asynchronous I/O stage.
+ *
+ * The coroutines start right away and destroy themselves when they finish; they report
+ * their outcome through the async_batch they belong to.
+ */
+struct async_task {
+  struct promise_type {
+    async_task get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+/**
+ * @brief The outcome of an asynchronous filesystem operation, as seen by the coroutine.
+ */
+struct fs_result {
+  bool ok;
+  fs_handle handle;
+};
+
+/**
+ * @brief Awaitable that starts an asynchronous filesystem operation and resumes the
+ * coroutine on the executor thread that processes its completion.
+ */
+template <typename Start>
+class fs_operation : public fs_request {
+public:
+  explicit fs_operation(Start start) : start(start) {}
+
+  bool await_ready() const noexcept { return false; }
+
+  void await_suspend(std::coroutine_handle<> handle) {
+    continuation = handle;
+    // The operation may complete and resume the coroutine on another thread before the
+    // call returns, which destroys this awaiter, so work on a copy of the starter.
+    Start starter = start;
+    starter(this);
+  }
+
+  fs_result await_resume() const noexcept {
+    return {ok, handle};
+  }
+
+  void complete() override {
+    continuation.resume();
+  }
+
+private:
+  Start start;
+  std::coroutine_handle<> continuation;
+};
+
+/**
+ * @brief Creates an fs_operation from a callable that starts the operation for a request.
+ */
+template <typename Start>
+fs_operation<Start> async_operation(Start start) {
+  return fs_operation<Start>(start);
+}
+
+/**
+ * @brief Shared state of the coroutines of an asynchronous I/O stage.
+ */
+class async_batch {
+public:
+  async_batch(filesystem &fs, io_executor &executor, concurrency_controller &controller,
+              std::atomic<size_t> &failures, std::mutex &existing_mutex, std::vector<std::string> &existing_files)
+    : fs(fs), executor(executor), controller(controller), failures(failures),
+      existing_mutex(existing_mutex), existing_files(existing_files), in_flight(0) {}
+
+  /**
+   * @brief Blocks until fewer than limit files are in flight and claims a slot.
+   */
+  void acquire(unsigned limit) {
+    std::unique_lock<std::mutex> lock(mutex);
+    slot_free.wait(lock, [&] { return in_flight < limit; });
+    in_flight++;
+  }
+
+  /**
+   * @brief Blocks until every file has finished.
+   */
+  void wait_idle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    slot_free.wait(lock, [&] { return in_flight == 0; });
+  }
+
+  /**
+   * @brief Records the outcome of a file and releases its slot.
+   */
+  void finish(batch_item *item, bool failed, bool existed, std::chrono::steady_clock::time_point start) {
+    if (failed) {
+      failures++;
+    }
+    else if (existed) {
+      std::lock_guard<std::mutex> lock(existing_mutex);
+      existing_files.push_back(item->filename);
+    }
+    controller.record(std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start).count());
+    delete item;
+    // Notified under the mutex: once wait_idle() sees the batch idle, the feeder destroys
+    // it, so nothing may touch the batch after the mutex is released.
+    std::lock_guard<std::mutex> lock(mutex);
+    in_flight--;
+    slot_free.notify_all();
+  }
+
+  filesystem &fs;
+  io_executor &executor;
+
+private:
+  concurrency_controller &controller;
+  std::atomic<size_t> &failures;
+  std::mutex &existing_mutex;
+  std::vector<std::string> &existing_files;
+  std::mutex mutex;
+  std::condition_variable slot_free;
+  unsigned in_flight;
+};
+
+/**
+ * @brief Creates one file of a batch: stat, create, write and close as a coroutine.
+ *
+ * Between the steps the coroutine is suspended and holds no thread, so the number of
+ * files in flight is only bounded by memory, not by the number of threads.
+ */
+async_task create_file_async(async_batch &batch, batch_item *item) {
+  auto start = std::chrono::steady_clock::now();
+  filesystem &fs = batch.fs;
+  io_executor &executor = batch.executor;
+  const std::string &filename = item->filename;
+  const std::string &message = item->message;
+  bool failed = false;
+
+  fs_result existing = co_await async_operation([&](fs_request *request) {
+    fs.stat_async(executor, filename, request);
+  });
+  if (!existing.ok) {
+    fs_result created = co_await async_operation([&](fs_request *request) {
+      fs.create_async(executor, filename, request);
+    });
+    TRACE_POINT("FileOpen", TraceLoggingString(filename.c_str(), "Path"), TraceLoggingBool(created.ok, "Ok"));
+    if (!created.ok) {
+      ERROR_PRINT("Error: Could not create file %s\n", filename.c_str());
+      failed = true;
+    }
+    else {
+      bool written = true;
+      unsigned long long offset = 0;
+      while (written && offset < message.size()) {
+        // Overlapped writes take a 32-bit length, so very large messages are split.
+        size_t chunk = std::min<size_t>(message.size() - (size_t)offset, 0x40000000);
+        fs_result result = co_await async_operation([&](fs_request *request) {
+          request->offset = offset;
+          fs.write_async(executor, created.handle, message.data() + offset, chunk, request);
+        });
+        written = result.ok;
+        offset += chunk;
+      }
+      TRACE_POINT("FileWrite", TraceLoggingString(filename.c_str(), "Path"), TraceLoggingUInt64(offset, "Bytes"),
+                  TraceLoggingBool(written, "Ok"));
+      fs_result closed = co_await async_operation([&](fs_request *request) {
+        fs.close_async(executor, created.handle, request);
+      });
+      TRACE_POINT("FileClose", TraceLoggingString(filename.c_str(), "Path"), TraceLoggingBool(closed.ok, "Ok"));
+      if (!written || !closed.ok) {
+        ERROR_PRINT("Error: Could not write to file %s\n", filename.c_str());
+        failed = true;
+      }
+    }
+  }
+  batch.finish(item, failed, existing.ok, start);
+}
+#endif
+
+/**
+ * @brief Creates a batch of files with a pipeline of threads connected by bounded queues.
+ *
+ * The stages are:
+ * - read: walks the command-line names and list files (one thread);
+ * - classify: determines each file's type and the directory_shard of its parent directory
+ *   (one thread);
+ * - render: renders the messages and appends the files to their shards (a few threads);
+ * - I/O: leases shards with files waiting and creates and writes their files (the -j
+ *   workers), or, with --async, runs every file as a coroutine on an io_executor with a
+ *   handful of threads.
+ *
+ * Because the queues are bounded and rendering pauses while MAX_PENDING_ITEMS rendered
+ * files wait for the I/O stage, a slow file system stops the renderers, which fills the
+ * queues before them, which in turn stops the reader: memory use stays constant no matter
+ * how long the input is.
+ *
+ * A directory is leased to one worker at a time, which opens it once per lease and
+ * creates the files relative to it, since creates within one directory serialize on the
+ * directory's lock anyway.
+ * Files that already exist are not touched by the workers; they are collected and
+ * handled afterwards on the main thread, so the overwrite confirmation still works as it
+ * does for a single file.
+ *
+ * @param fs The filesystem backend to create the files with.
+ * @param inputs The command-line names and list files.
+ * @param options The batch settings.
+ * @return True if every file was created.
+ */
+bool run_batch(filesystem &fs, const std::vector<batch_input> &inputs, const batch_options &options) {
+  auto start = std::chrono::steady_clock::now();
+  unsigned workers = (options.async_in_flight > 0) ? 1 : std::max(1u, options.jobs);
+  unsigned renderers = std::max(1u, std::min(MAX_RENDER_THREADS, std::thread::hardware_concurrency() / 2));
+  concurrency_controller controller(1, (options.async_in_flight > 0) ? options.async_in_flight : workers);
+
+  stage_queue<spsc_queue<batch_item *>, batch_item *> read_queue("read -> classify", 1024, 1);
+  stage_queue<mpmc_queue<batch_item *>, batch_item *> classify_queue("classify -> render", 1024, 1);
+  stage_queue<mpmc_queue<directory_shard *>, directory_shard *> render_queue("render -> I/O", 64, renderers);
+
+  std::atomic<size_t> total(0);
+  std::atomic<size_t> failures(0);
+  std::atomic<bool> finished(false);
+  std::mutex existing_mutex;
+  std::vector<std::string> existing_files;
+  // The shards of every directory, kept until every stage is done.
+  std::unordered_map<std::string, std::unique_ptr<directory_shard>> shards;
+  // Rendered files not yet taken by the I/O stage.
+  std::mutex buffered_mutex;
+  std::condition_variable buffer_free;
+  size_t buffered = 0;
+  auto release_buffered = [&]() {
+    {
+      std::lock_guard<std::mutex> lock(buffered_mutex);
+      buffered--;
+    }
+    buffer_free.notify_one();
+  };
+
+  // Read stage.
+  std::thread reader([&]() {
+    if (!for_each_target(inputs, [&](const std::string &filename) {
+          read_queue.push(new batch_item{filename, std::string(), std::string(), nullptr});
+          total++;
+        })) {
+      failures++;
+    }
+    read_queue.producer_done();
+  });
+
+  // Classify stage.
+  std::thread classifier([&]() {
+    batch_item *item;
+    while (read_queue.pop(&item)) {
+      item->extension = get_file_extension(item->filename);
+      std::string directory = split_parent(item->filename);
+      for (char &c : directory) {
+        if (c == '/') c = '\\';
+      }
+      std::unique_ptr<directory_shard> &shard = shards[directory];
+      if (!shard) {
+        shard.reset(new directory_shard());
+        shard->directory = directory;
+      }
+      item->shard = shard.get();
+      classify_queue.push(item);
+    }
+    classify_queue.producer_done();
+  });
+
+  // Render stage.
+  std::vector<std::thread> render_threads;
+  for (unsigned i = 0; i < renderers; i++) {
+    render_threads.emplace_back([&]() {
+      batch_item *item;
+      while (classify_queue.pop(&item)) {
+        item->message = render_file_message(item->filename, item->extension);
+        {
+          std::unique_lock<std::mutex> lock(buffered_mutex);
+          buffer_free.wait(lock, [&] { return buffered < MAX_PENDING_ITEMS; });
+          buffered++;
+        }
+        if (item->shard->append(item)) {
+          render_queue.push(item->shard);
+        }
+      }
+      render_queue.producer_done();
+    });
+  }
+
+  // I/O stage.
+  std::mutex gate_mutex;
+  std::condition_variable gate;
+  unsigned active = 0;
+  std::vector<std::thread> io_threads;
+#if defined(__cpp_impl_coroutine)
+  std::unique_ptr<io_executor> executor;
+  if (options.async_in_flight > 0) {
+    executor.reset(new io_executor(std::max(1u, std::min(ASYNC_THREADS, std::thread::hardware_concurrency()))));
+    // A single thread feeds the coroutines; it only blocks when the in-flight limit is reached.
+    io_threads.emplace_back([&]() {
+      async_batch state(fs, *executor, controller, failures, existing_mutex, existing_files);
+      directory_shard *shard;
+      std::vector<batch_item *> items;
+      while (render_queue.pop(&shard)) {
+        bool directory_ok = shard->prepare(fs, options.parents);
+        while (shard->take(&items)) {
+          for (batch_item *item : items) {
+            release_buffered();
+            if (!directory_ok) {
+              ERROR_PRINT("Error: Could not open directory for %s\n", item->filename.c_str());
+              failures++;
+              delete item;
+              continue;
+            }
+            state.acquire(options.adaptive ? controller.limit() : options.async_in_flight);
+            create_file_async(state, item);
+          }
+          items.clear();
+        }
+      }
+      state.wait_idle();
+    });
+  }
+#endif
+  for (unsigned i = 0; i < workers && options.async_in_flight == 0; i++) {
+    io_threads.emplace_back([&]() {
+      directory_shard *shard;
+      std::vector<batch_item *> items;
+      while (render_queue.pop(&shard)) {
+        fs_handle directory = nullptr;
+        if (shard->prepare(fs, options.parents)) {
+          directory = fs.open_dir(shard->directory);
+        }
+        while (shard->take(&items)) {
+          for (batch_item *item : items) {
+            if (options.adaptive) {
+              // Workers above the controller's limit park here until the limit is raised.
+              std::unique_lock<std::mutex> lock(gate_mutex);
+              gate.wait(lock, [&] { return active < controller.limit(); });
+              active++;
+            }
+            auto op_start = std::chrono::steady_clock::now();
+            file_stat existing;
+            if (directory == nullptr) {
+              ERROR_PRINT("Error: Could not open directory for %s\n", item->filename.c_str());
+              failures++;
+            }
+            else if (fs.stat(item->filename, &existing)) {
+              std::lock_guard<std::mutex> lock(existing_mutex);
+              existing_files.push_back(item->filename);
+            }
+            else if (!write_file(fs, item->filename, item->message, directory, options.payload)) {
+              failures++;
+            }
+            auto op_end = std::chrono::steady_clock::now();
+            controller.record(std::chrono::duration_cast<std::chrono::microseconds>(op_end - op_start).count());
+            if (options.adaptive) {
+              {
+                std::lock_guard<std::mutex> lock(gate_mutex);
+                active--;
+              }
+              gate.notify_one();
+            }
+            delete item;
+            release_buffered();
+          }
+          items.clear();
+        }
+        if (directory != nullptr) {
+          fs.close_dir(directory);
+        }
+      }
+    });
+  }
+
+  // The control loop runs on the main thread until the I/O stage is done.
+  std::thread watcher([&]() {
+    for (std::thread &thread : io_threads) {
+      thread.join();
+    }
+    finished = true;
+  });
+  if (options.adaptive) {
+    while (!finished.load()) {
+      sleep_microseconds(1000);
+      if (controller.tick()) {
+        gate.notify_all();
+      }
+    }
+  }
+  watcher.join();
+  reader.join();
+  classifier.join();
+  for (std::thread &thread : render_threads) {
+    thread.join();
+  }
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  if (options.timings) {
+    size_t created = total.load() - existing_files.size() - failures.load();
+    ERROR_PRINT("touch: batch of %zu files\n", total.load());
+    ERROR_PRINT("  created: %zu, existing: %zu, failed: %zu\n", created, existing_files.size(), failures.load());
+    ERROR_PRINT("  elapsed: %.3f s, %.0f files/s\n", elapsed, elapsed > 0 ? created / elapsed : 0.0);
+    if (options.adaptive) {
+      controller.print_summary();
+    }
+    else if (options.async_in_flight > 0) {
+      ERROR_PRINT("  concurrency: fixed %u in flight\n", options.async_in_flight);
+    }
+    else {
+      ERROR_PRINT("  concurrency: fixed %u\n", workers);
+    }
+#if defined(__cpp_impl_coroutine)
+    if (executor) {
+      ERROR_PRINT("  async executor: %zu threads\n", executor->thread_count());
+    }
+#endif
+    ERROR_PRINT("  %-18s %8s %9s %9s %8s %9s %8s %9s\n", "queue", "capacity", "avg fill", "max fill",
+                "full", "full ms", "empty", "empty ms");
+    read_queue.print_stats();
+    classify_queue.print_stats();
+    render_queue.print_stats();
+  }
+
+  // Existing files need the interactive confirmation, so they are handled one by one.
+  bool ok = failures.load() == 0;
+  for (const std::string &filename : existing_files) {
+    if (create_file(fs, filename, false, options.payload) == CREATE_FAILED) {
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+/**
+ * @brief A value of a request of the --serve-stdio protocol.
+ */
+struct json_value {
+  bool is_string;   /**< True for strings, false for numbers, booleans and null. */
+  std::string text; /**< The unescaped string, or the literal as written. */
+};
+
+/**
+ * @brief Returns the length of the well-formed UTF-8 sequence at value[i], or 0 if none.
+ */
+size_t utf8_sequence_length(const std::string &value, size_t i) {
+  unsigned char lead = (unsigned char)value[i];
+  size_t length;
+  unsigned char low = 0x80, high = 0xBF; // Range of the second byte
+  if (lead >= 0xC2 && lead <= 0xDF) length = 2;
+  else if (lead >= 0xE0 && lead <= 0xEF) {
+    length = 3;
+    if (lead == 0xE0) low = 0xA0;       // Overlong
+    else if (lead == 0xED) high = 0x9F; // Surrogates
+  }
+  else if (lead >= 0xF0 && lead <= 0xF4) {
+    length = 4;
+    if (lead == 0xF0) low = 0x90;       // Overlong
+    else if (lead == 0xF4) high = 0x8F; // Above U+10FFFF
+  }
+  else return 0;
+  if (i + length > value.size()) return 0;
+  for (size_t k = 1; k < length; k++) {
+    unsigned char c = (unsigned char)value[i + k];
+    if (c < (k == 1 ? low : 0x80) || c > (k == 1 ? high : 0xBF)) return 0;
+  }
+  return length;
+}
+
+/**
+ * @brief Quotes a string as a JSON string literal.
+ *
+ * Bytes that aren't part of well-formed UTF-8, such as ANSI file names, are replaced by
+ * U+FFFD so the response stays valid JSON.
+ */
+std::string json_quote(const std::string &value) {
+  static const char hex[] = "0123456789abcdef";
+  std::string out;
+  out.reserve(value.size() + 2);
+  out += '"';
+  for (size_t i = 0; i < value.size(); i++) {
+    char c = value[i];
+    if ((unsigned char)c >= 0x80) {
+      size_t length = utf8_sequence_length(value, i);
+      if (length == 0) {
+        out += "\\ufffd";
+      }
+      else {
+        out.append(value, i, length);
+        i += length - 1;
+      }
+      continue;
+    }
+    switch (c) {
+      case '"':  out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if ((unsigned char)c < 0x20) {
+          out += "\\u00";
+          out += hex[(c >> 4) & 0xF];
+          out += hex[c & 0xF];
+        }
+        else {
+          out += c;
+        }
+    }
+  }
+  out += '"';
+  return out;
+}
+
+/**
+ * @brief Appends a Unicode code point to a string in UTF-8.
+ */
+void append_utf8(unsigned code, std::string *out) {
+  if (code < 0x80) {
+    out->push_back((char)code);
+  }
+  else if (code < 0x800) {
+    out->push_back((char)(0xC0 | (code >> 6)));
+    out->push_back((char)(0x80 | (code & 0x3F)));
+  }
+  else if (code < 0x10000) {
+    out->push_back((char)(0xE0 | (code >> 12)));
+    out->push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+    out->push_back((char)(0x80 | (code & 0x3F)));
+  }
+  else {
+    out->push_back((char)(0xF0 | (code >> 18)));
+    out->push_back((char)(0x80 | ((code >> 12) & 0x3F)));
+    out->push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+    out->push_back((char)(0x80 | (code & 0x3F)));
+  }
+}
+
+/**
+ * @brief Parses a JSON string literal.
+ *
+ * @param text The text to parse.
+ * @param pos The position of the opening quote, moved past the closing quote.
+ * @param out The unescaped string.
+ * @return True if the literal is valid.
+ */
+bool parse_json_string(const std::string &text, size_t *pos, std::string *out) {
+  out->clear();
+  size_t i = *pos + 1;
+  while (i < text.size()) {
+    char c = text[i++];
+    if (c == '"') {
+      *pos = i;
+      return true;
+    }
+    if (c != '\\') {
+      out->push_back(c);
+      continue;
+    }
+    if (i >= text.size()) return false;
+    char escaped = text[i++];
+    switch (escaped) {
+      case '"': case '\\': case '/': out->push_back(escaped); break;
+      case 'b': out->push_back('\b'); break;
+      case 'f': out->push_back('\f'); break;
+      case 'n': out->push_back('\n'); break;
+      case 'r': out->push_back('\r'); break;
+      case 't': out->push_back('\t'); break;
+      case 'u': {
+        if (text.size() - i < 4) return false;
+        char *end = nullptr;
+        std::string digits = text.substr(i, 4);
+        unsigned code = (unsigned)strtoul(digits.c_str(), &end, 16);
+        if (end != digits.c_str() + 4) return false;
+        i += 4;
+        // Characters outside the basic plane arrive as a surrogate pair.
+        if (code >= 0xD800 && code < 0xDC00 && text.compare(i, 2, "\\u") == 0 && text.size() - i >= 6) {
+          std::string low_digits = text.substr(i + 2, 4);
+          unsigned low = (unsigned)strtoul(low_digits.c_str(), &end, 16);
+          if (end == low_digits.c_str() + 4 && low >= 0xDC00 && low < 0xE000) {
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            i += 6;
+          }
+        }
+        append_utf8(code, out);
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Parses a request of the --serve-stdio protocol: a flat JSON object whose values
+ * are strings, numbers, booleans or null.
+ *
+ * @param line The request line.
+ * @param out The members of the object.
+ * @return True if the line is a valid request.
+ */
+bool parse_json_object(const std::string &line, std::unordered_map<std::string, json_value> *out) {
+  size_t pos = line.find_first_not_of(" \t\r");
+  if (pos == std::string::npos || line[pos] != '{') return false;
+  pos = line.find_first_not_of(" \t\r", pos + 1);
+  if (pos != std::string::npos && line[pos] == '}') {
+    return line.find_first_not_of(" \t\r", pos + 1) == std::string::npos;
+  }
+  while (pos != std::string::npos && line[pos] == '"') {
+    std::string key;
+    if (!parse_json_string(line, &pos, &key)) return false;
+    pos = line.find_first_not_of(" \t\r", pos);
+    if (pos == std::string::npos || line[pos] != ':') return false;
+    pos = line.find_first_not_of(" \t\r", pos + 1);
+    if (pos == std::string::npos) return false;
+    json_value value;
+    value.is_string = line[pos] == '"';
+    if (value.is_string) {
+      if (!parse_json_string(line, &pos, &value.text)) return false;
+    }
+    else {
+      size_t end = line.find_first_of(",} \t\r", pos);
+      if (end == std::string::npos || end == pos) return false;
+      value.text = line.substr(pos, end - pos);
+      if (value.text != "true" && value.text != "false" && value.text != "null" &&
+          value.text.find_first_not_of("-+.eE0123456789") != std::string::npos) {
+        return false;
+      }
+      pos = end;
+    }
+    (*out)[key] = value;
+    pos = line.find_first_not_of(" \t\r", pos);
+    if (pos == std::string::npos) return false;
+    if (line[pos] == '}') {
+      return line.find_first_not_of(" \t\r", pos + 1) == std::string::npos;
+    }
+    if (line[pos] != ',') return false;
+    pos = line.find_first_not_of(" \t\r", pos + 1);
+  }
+  return false;
+}
+
+/**
+ * @brief Kinds of --serve-stdio requests with a latency histogram of their own.
+ */
+enum request_kind {
+  REQUEST_RENDER = 0,
+  REQUEST_CREATE = 1,
+  REQUEST_RELOAD = 2,
+  REQUEST_OTHER = 3, /**< Every other method, and invalid requests. */
+  REQUEST_KIND_COUNT = 4
+};
+
+/**
+ * @brief Returns the kind of a request from its method.
+ */
+request_kind request_kind_of(const std::string &method) {
+  if (method == "render") return REQUEST_RENDER;
+  if (method == "create") return REQUEST_CREATE;
+  if (method == "reload") return REQUEST_RELOAD;
+  return REQUEST_OTHER;
+}
+
+/**
+ * @brief Latency histograms of requests, per kind of request.
+ *
+ * The buckets are log-linear like those of HdrHistogram: exact below 32 ns, then every
+ * power of two is split into LATENCY_SUB_BUCKETS buckets, so any latency is known to about
+ * 6% without fixing a range in advance. Every thread records into histograms of its own,
+ * which only it writes, so recording takes no lock and no interlocked instruction;
+ * prometheus_text() merges them.
+ */
+class latency_histograms {
+public:
+  /**
+   * @brief Records the latency of a request, in nanoseconds.
+   */
+  void record(request_kind kind, unsigned long long nanoseconds) {
+    histogram &own = thread_histograms().kinds[kind];
+    add(own.buckets[bucket_of(nanoseconds)], 1);
+    add(own.sum, nanoseconds);
+  }
+
+  /**
+   * @brief Returns the merged histograms and the service counters in the Prometheus text format.
+   *
+   * Only non-empty buckets are listed; the buckets are cumulative, as the format wants them.
+   */
+  std::string prometheus_text() {
+    static const char *names[REQUEST_KIND_COUNT] = {"render", "create", "reload", "other"};
+    std::vector<unsigned long long> counts(LATENCY_BUCKETS);
+    std::string out;
+    char line[160];
+    out += "# HELP touch_request_duration_seconds Time to answer a request.\n";
+    out += "# TYPE touch_request_duration_seconds histogram\n";
+    for (int kind = 0; kind < REQUEST_KIND_COUNT; kind++) {
+      std::fill(counts.begin(), counts.end(), 0);
+      unsigned long long sum = 0;
+      {
+        std::lock_guard<std::mutex> lock(threads_mutex);
+        for (const auto &thread : threads) {
+          const histogram &merged = thread->kinds[kind];
+          for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+            counts[i] += merged.buckets[i].load(std::memory_order_relaxed);
+          }
+          sum += merged.sum.load(std::memory_order_relaxed);
+        }
+      }
+      unsigned long long total = 0;
+      for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+        if (counts[i] == 0) continue;
+        total += counts[i];
+        // A bucket holds whole nanoseconds, so its largest value is its upper bound.
+        snprintf(line, sizeof(line), "touch_request_duration_seconds_bucket{method=\"%s\",le=\"%.9g\"} %llu\n",
+                 names[kind], (bucket_end(i) - 1) / 1e9, total);
+        out += line;
+      }
+      snprintf(line, sizeof(line), "touch_request_duration_seconds_bucket{method=\"%s\",le=\"+Inf\"} %llu\n",
+               names[kind], total);
+      out += line;
+      snprintf(line, sizeof(line), "touch_request_duration_seconds_sum{method=\"%s\"} %.9f\n", names[kind], sum / 1e9);
+      out += line;
+      snprintf(line, sizeof(line), "touch_request_duration_seconds_count{method=\"%s\"} %llu\n", names[kind], total);
+      out += line;
+    }
+    auto counter = [&](const char *name, const char *help, const std::atomic<unsigned long long> &value) {
+      snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s counter\n%s %llu\n", name, help, name, name,
+               value.load(std::memory_order_relaxed));
+      out += line;
+    };
+    counter("touch_config_reloads_total", "Reload requests.", service_stats.config_reloads);
+    counter("touch_config_cache_hits_total", "Configurations mapped from the cache.", service_stats.config_cache_hits);
+    counter("touch_config_cache_misses_total", "Configurations parsed and cached again.", service_stats.config_cache_misses);
+    return out;
+  }
+
+private:
+  /**
+   * @brief The counts of one kind of request recorded by one thread.
+   */
+  struct histogram {
+    std::atomic<unsigned long long> buckets[LATENCY_BUCKETS] = {};
+    std::atomic<unsigned long long> sum{0}; /**< Nanoseconds. */
+  };
+
+  /**
+   * @brief The histograms of one thread.
+   */
+  struct per_thread {
+    histogram kinds[REQUEST_KIND_COUNT];
+  };
+
+  /**
+   * @brief Adds to a counter only the calling thread writes; readers may see it at any time.
+   */
+  static void add(std::atomic<unsigned long long> &counter, unsigned long long value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Returns the bucket of a latency.
+   */
+  static size_t bucket_of(unsigned long long nanoseconds) {
+    if (nanoseconds < 2 * LATENCY_SUB_BUCKETS) return (size_t)nanoseconds;
+    unsigned shift = 0;
+    while ((nanoseconds >> shift) >= 2 * LATENCY_SUB_BUCKETS) shift++;
+    return (size_t)((shift + 1) * LATENCY_SUB_BUCKETS + (nanoseconds >> shift) - LATENCY_SUB_BUCKETS);
+  }
+
+  /**
+   * @brief Returns one past the largest latency of a bucket.
+   */
+  static unsigned long long bucket_end(size_t bucket) {
+    if (bucket < 2 * LATENCY_SUB_BUCKETS) return bucket + 1;
+    unsigned shift = (unsigned)(bucket / LATENCY_SUB_BUCKETS) - 1;
+    unsigned long long mantissa = LATENCY_SUB_BUCKETS + bucket % LATENCY_SUB_BUCKETS;
+    return (mantissa + 1) << shift;
+  }
+
+  /**
+   * @brief The calling thread's histograms, registered on first use so readers can see them.
+   *
+   * They outlive their thread. There is a single instance per process, so a thread_local
+   * pointer is enough.
+   */
+  per_thread &thread_histograms() {
+    static thread_local per_thread *local = nullptr;
+    if (local == nullptr) {
+      std::lock_guard<std::mutex> lock(threads_mutex);
+      threads.emplace_back(new per_thread());
+      local = threads.back().get();
+    }
+    return *local;
+  }
+
+  std::mutex threads_mutex;
+  std::vector<std::unique_ptr<per_thread>> threads;
+};
+
+/**
+ * @brief The request latencies of --serve-stdio.
+ */
+latency_histograms request_latencies;
+
+/**
+ * @brief Creates a file for a create request of --serve-stdio or --serve-pipe.
+ *
+ * @param fs The filesystem backend.
+ * @param filename The file to create.
+ * @param parents True to create missing directories.
+ * @param overwrite True to replace an existing file; there is nobody to ask for confirmation.
+ * @return The error to report, or an empty string on success.
+ */
+std::string create_requested_file(filesystem &fs, const std::string &filename, bool parents, bool overwrite) {
+  file_stat existing;
+  if (parents && !make_parents(fs, split_parent(filename))) {
+    return "could not create directory";
+  }
+  if (fs.stat(filename, &existing) && !overwrite) {
+    return "file exists";
+  }
+  if (!write_file(fs, filename, render_file_message(filename, get_file_extension(filename)))) {
+    return "could not write file";
+  }
+  return std::string();
+}
+
+/**
+ * @brief Runs touch as a co-process answering JSON-lines requests on stdin.
+ *
+ * Editors keep one process running instead of starting touch, and parsing the
+ * configuration, for every new buffer. Every request is a JSON object on one line and
+ * gets exactly one response line, in order. The "id" of a request, if any, is copied into
+ * its response. The methods are:
+ * - {"method": "render", "file": F}: responds {"ok": true, "content": ...} with the
+ *   message rendered for F, without touching the disk;
+ * - {"method": "create", "file": F}: creates F like touch F would, with "parents": true
+ *   to create missing directories and "overwrite": true to replace an existing file
+ *   (there is nobody to ask for confirmation);
+ * - {"method": "reload"}: reads the configuration file again;
+ * - {"method": "version"}: responds {"ok": true, "version": ...};
+ * - {"method": "stats"}: responds {"ok": true, "stats": ...} with the latencies of the
+ *   requests so far and the counters of the process, in the Prometheus text format;
+ * - {"method": "exit"}: ends the process, as does the end of stdin.
+ * Failed requests get {"ok": false, "error": ...}.
+ *
+ * @param fs The filesystem backend for "create".
+ * @param use_config_cache False to parse the configuration file on "reload".
+ * @return EXIT_SUCCESS once stdin ends or an exit request arrives.
+ */
+int serve_stdio(filesystem &fs, bool use_config_cache) {
+  std::string line;
+  while (read_line(stdin, &line)) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+    auto start = std::chrono::steady_clock::now();
+    std::unordered_map<std::string, json_value> request;
+    bool valid = parse_json_object(line, &request);
+    std::string response = "{";
+    auto id = request.find("id");
+    if (id != request.end()) {
+      response += "\"id\":" + (id->second.is_string ? json_quote(id->second.text) : id->second.text) + ",";
+    }
+    auto member = [&](const char *name) {
+      auto it = request.find(name);
+      return (it != request.end()) ? it->second.text : std::string();
+    };
+    std::string method = member("method");
+    std::string filename = member("file");
+    std::string error;
+    bool done = false;
+
+    if (!valid) {
+      error = "invalid request";
+    }
+    else if (method == "render" || method == "create") {
+      if (filename.empty()) {
+        error = "missing file";
+      }
+      else if (method == "render") {
+        response += "\"ok\":true,\"content\":" + json_quote(render_file_message(filename, get_file_extension(filename)));
+      }
+      else {
+        error = create_requested_file(fs, filename, member("parents") == "true", member("overwrite") == "true");
+        if (error.empty()) {
+          response += "\"ok\":true";
+        }
+      }
+    }
+    else if (method == "reload") {
+      load_config(probe_config(true), use_config_cache);
+      service_stats.config_reloads.fetch_add(1, std::memory_order_relaxed);
+      response += "\"ok\":true";
+    }
+    else if (method == "stats") {
+      response += "\"ok\":true,\"stats\":" + json_quote(request_latencies.prometheus_text());
+    }
+    else if (method == "version") {
+      response += "\"ok\":true,\"version\":" + json_quote(VERSION);
+    }
+    else if (method == "exit") {
+      response += "\"ok\":true";
+      done = true;
+    }
+    else {
+      error = "unknown method";
+    }
+
+    if (!error.empty()) {
+      response += "\"ok\":false,\"error\":" + json_quote(error);
+    }
+    response += "}\n";
+    // The latency ends once the response is complete, not once the editor has read it.
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    request_latencies.record(request_kind_of(method), elapsed.count());
+    // Each response is written right away, the editor is waiting for it.
+    if (!write_stdout(response) || done) break;
+  }
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Operations of the --serve-pipe protocol.
+ */
+enum pipe_operation {
+  PIPE_RENDER = 1, /**< Responds with the message rendered for the file in the payload. */
+  PIPE_CREATE = 2, /**< Creates the file in the payload, see PIPE_PARENTS and PIPE_OVERWRITE. */
+  PIPE_RELOAD = 3, /**< Reads the configuration file again. */
+  PIPE_STATS = 4   /**< Responds with the text of a "stats" request of --serve-stdio. */
+};
+
+/**
+ * @brief Flags of a PIPE_CREATE request.
+ */
+enum pipe_flag {
+  PIPE_PARENTS = 1,  /**< Create missing directories. */
+  PIPE_OVERWRITE = 2 /**< Replace an existing file. */
+};
+
+/**
+ * @brief Serves the binary --serve-pipe protocol on a named pipe.
+ *
+ * Build tools and editors send bursts of requests, so a client doesn't wait for one
+ * response before sending the next request. Every frame starts with its length and the
+ * ID the client chose for the request, all numbers are little-endian:
+ * - a request is u32 length, u32 id, u8 operation, u8 flags and the file name; the length
+ *   counts everything after itself;
+ * - a response is u32 length, u32 id, u8 status (0 on success) and the content, or the
+ *   error if the status isn't 0.
+ * Requests are carried out by a pool of workers and answered as soon as they are done,
+ * so responses can come in any order; the ID tells them apart. Responses finished while
+ * a write is in flight go out together in the next write.
+ *
+ * The pipe I/O of every client runs on a small io_executor, so thousands of clients only
+ * cost their buffers. A client with PIPE_MAX_IN_FLIGHT requests in progress isn't read
+ * from until half of them are answered.
+ */
+class pipe_server {
+public:
+  pipe_server(filesystem &fs, bool use_config_cache, const std::string &name, unsigned jobs)
+    : fs(fs), use_config_cache(use_config_cache), name(name), io(ASYNC_THREADS), workers(jobs) {
+  }
+
+  /**
+   * @brief Starts listening for clients.
+   * @return False if the pipe couldn't be created, e.g. because another server owns it.
+   */
+  bool start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (unsigned i = 0; i < PIPE_LISTENERS; i++) {
+      accept_task *task = new accept_task(this);
+      if (!listen(task, i == 0)) {
+        delete task;
+        return i > 0;
+      }
+      listeners.insert(task);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Stops accepting clients and waits until every client is closed.
+   *
+   * Waiting for clients is cancelled and clients are no longer read from, but requests
+   * already received are still answered; a client is closed once its last response is
+   * written. Writes still pending after PIPE_DRAIN_TIMEOUT are cancelled. The executors
+   * only stop afterwards, so nothing is left pending on them.
+   */
+  void stop() {
+    std::vector<connection *> paused;
+    std::unique_lock<std::mutex> lock(mutex);
+    stopping = true;
+    for (accept_task *task : listeners) {
+      CancelIoEx(task->pipe, task);
+    }
+    for (connection *client : connections) {
+      if (client->stop_reading()) paused.push_back(client);
+    }
+    lock.unlock();
+    // A paused client has no read to cancel, so its read loop ends here.
+    for (connection *client : paused) {
+      client->close();
+    }
+    lock.lock();
+    while (!drained.wait_for(lock, std::chrono::milliseconds(PIPE_DRAIN_TIMEOUT),
+                             [&] { return listeners.empty() && connections.empty(); })) {
+      // A client that doesn't read its responses would keep its write pending forever.
+      for (connection *client : connections) {
+        CancelIoEx(client->pipe, NULL);
+      }
+    }
+  }
+
+private:
+  struct connection;
+
+  /**
+   * @brief Waits for the next client on a pipe instance of its own.
+   */
+  struct accept_task : io_task {
+    explicit accept_task(pipe_server *server) : server(server), pipe(INVALID_HANDLE_VALUE) {}
+
+    void run(bool ok, DWORD) override {
+      std::unique_lock<std::mutex> lock(server->mutex);
+      if (ok && !server->stopping) {
+        connection *client = new connection(server, pipe);
+        server->connections.insert(client);
+        lock.unlock();
+        client->read();
+        lock.lock();
+      }
+      else {
+        CloseHandle(pipe);
+      }
+      memset(static_cast<OVERLAPPED *>(this), 0, sizeof(OVERLAPPED));
+      if (server->stopping || !server->listen(this, false)) {
+        server->listeners.erase(this);
+        server->drained.notify_all();
+        delete this;
+      }
+    }
+
+    pipe_server *server;
+    HANDLE pipe;
+  };
+
+  /**
+   * @brief The read or the write a connection has in flight.
+   */
+  struct connection_io : io_task {
+    connection_io(connection *client, bool reading) : client(client), reading(reading) {}
+
+    void run(bool ok, DWORD bytes) override {
+      if (reading) {
+        client->received(ok, bytes);
+      }
+      else {
+        client->sent(ok, bytes);
+      }
+    }
+
+    connection *client;
+    bool reading;
+  };
+
+  /**
+   * @brief A request being carried out by a worker.
+   */
+  struct request_task : io_task {
+    void run(bool, DWORD) override {
+      client->server->answer(this);
+    }
+
+    connection *client;
+    uint32_t id;
+    unsigned char operation;
+    unsigned char flags;
+    std::string filename;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  /**
+   * @brief A connected client.
+   *
+   * The connection lives while it is read from, a write is in flight or one of its
+   * requests is in progress. Reads are never concurrent, so only writes, the request
+   * count and starting a read need the mutex. Once the read loop ends the requests
+   * received are still answered; a failed write drops the responses not written yet.
+   */
+  struct connection {
+    connection(pipe_server *server, HANDLE pipe)
+      : server(server), pipe(pipe), references(1), reader(this, true), writer(this, false) {}
+
+    /**
+     * @brief Reads what the client sent next; holds the reference of the read loop.
+     */
+    void read() {
+      bool started;
+      {
+        // Started under the mutex, so stop_reading() either sees the read or prevents it.
+        std::lock_guard<std::mutex> lock(mutex);
+        memset(static_cast<OVERLAPPED *>(&reader), 0, sizeof(OVERLAPPED));
+        started = !stopping &&
+                  (ReadFile(pipe, buffer, sizeof(buffer), NULL, &reader) || GetLastError() == ERROR_IO_PENDING);
+      }
+      if (!started) close();
+    }
+
+    /**
+     * @brief Ends the read loop for pipe_server::stop(), cancelling the read in flight.
+     * @return True if reading was paused, so the caller has to close() the read loop.
+     */
+    bool stop_reading() {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+      if (read_paused) {
+        read_paused = false;
+        return true;
+      }
+      CancelIoEx(pipe, &reader);
+      return false;
+    }
+
+    /**
+     * @brief Hands every complete request received so far to the workers.
+     */
+    void received(bool ok, DWORD bytes) {
+      if (!ok || bytes == 0) {
+        close();
+        return;
+      }
+      input.append(buffer, bytes);
+      size_t pos = 0;
+      while (input.size() - pos >= 4) {
+        uint32_t length;
+        memcpy(&length, input.data() + pos, 4);
+        if (length < 6 || length > PIPE_MAX_FRAME) {
+          ERROR_PRINT("Error: Invalid frame from a --serve-pipe client\n");
+          close();
+          return;
+        }
+        if (input.size() - pos - 4 < length) break;
+        request_task *task = new request_task();
+        task->client = this;
+        memcpy(&task->id, input.data() + pos + 4, 4);
+        task->operation = (unsigned char)input[pos + 8];
+        task->flags = (unsigned char)input[pos + 9];
+        task->filename.assign(input, pos + 10, length - 6);
+        task->start = std::chrono::steady_clock::now();
+        pos += 4 + length;
+        references.fetch_add(1, std::memory_order_relaxed);
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          in_flight++;
+        }
+        server->workers.post(task);
+      }
+      input.erase(0, pos);
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (in_flight >= PIPE_MAX_IN_FLIGHT && !stopping) {
+          read_paused = true;
+          return;
+        }
+      }
+      read();
+    }
+
+    /**
+     * @brief Queues the response of a request and ends the request.
+     */
+    void respond(const std::string &frame) {
+      bool resume = false;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        in_flight--;
+        if (!closed) {
+          pending += frame;
+          if (!write_in_flight) write_pending();
+        }
+        // After a failed write the read loop ends on its next read, as the client is gone.
+        if (read_paused && (closed || in_flight <= PIPE_MAX_IN_FLIGHT / 2)) {
+          read_paused = false;
+          resume = true;
+        }
+      }
+      if (resume) read();
+      release();
+    }
+
+    /**
+     * @brief Called when a write finished; writes what was queued in the meantime.
+     */
+    void sent(bool ok, DWORD bytes) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (ok && !writer_failed) {
+          writing.erase(0, bytes);
+        }
+        else {
+          writer_failed = false;
+          closed = true;
+          writing.clear();
+          pending.clear();
+        }
+        if (!writing.empty()) {
+          issue_write();
+          return;
+        }
+        write_in_flight = false;
+        if (!pending.empty()) {
+          write_pending();
+          return;
+        }
+      }
+      release();
+    }
+
+    /**
+     * @brief Starts writing the queued responses; the write holds a reference. Needs the mutex.
+     */
+    void write_pending() {
+      writing.swap(pending);
+      write_in_flight = true;
+      references.fetch_add(1, std::memory_order_relaxed);
+      issue_write();
+    }
+
+    void issue_write() {
+      memset(static_cast<OVERLAPPED *>(&writer), 0, sizeof(OVERLAPPED));
+      if (!WriteFile(pipe, writing.data(), (DWORD)writing.size(), NULL, &writer) && GetLastError() != ERROR_IO_PENDING) {
+        // No completion will come, so fail the write from an executor thread.
+        writer_failed = true;
+        server->io.post(&writer);
+      }
+    }
+
+    /**
+     * @brief Ends the read loop; requests in progress still finish and are answered.
+     */
+    void close() {
+      release();
+    }
+
+    void release() {
+      if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // Forgotten before the handle is closed: stop() cancels the I/O of the clients it
+        // still knows under the server's mutex, so it never sees a closed or reused handle.
+        // The server may be gone once forget() returns.
+        server->forget(this);
+        CloseHandle(pipe);
+        delete this;
+      }
+    }
+
+    pipe_server *server;
+    HANDLE pipe;
+    std::atomic<long> references;
+    connection_io reader;
+    connection_io writer;
+    char buffer[PIPE_BUFFER_SIZE];
+    std::string input;      /**< Received bytes not forming a complete request yet. */
+    std::mutex mutex;
+    std::string pending;    /**< Responses waiting for the write in flight. */
+    std::string writing;    /**< The responses being written. */
+    bool write_in_flight = false;
+    bool writer_failed = false;
+    bool read_paused = false;
+    bool closed = false;    /**< True once a write failed. */
+    bool stopping = false;  /**< True once the server stops, no read is started anymore. */
+    unsigned in_flight = 0; /**< Requests handed to the workers and not answered yet. */
+  };
+
+  /**
+   * @brief Forgets a closed client and wakes stop().
+   */
+  void forget(connection *client) {
+    std::lock_guard<std::mutex> lock(mutex);
+    connections.erase(client);
+    drained.notify_all();
+  }
+
+  /**
+   * @brief Creates a pipe instance and waits for a client on it. Needs the mutex.
+   * @param first True to fail if another process already serves the pipe.
+   */
+  bool listen(accept_task *task, bool first) {
+    DWORD open_mode = PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | (first ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0);
+    task->pipe = CreateNamedPipeA(name.c_str(), open_mode, PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                                  PIPE_UNLIMITED_INSTANCES, PIPE_BUFFER_SIZE, PIPE_BUFFER_SIZE, 0, NULL);
+    if (task->pipe == INVALID_HANDLE_VALUE) {
+      ERROR_PRINT("Error: Could not create pipe %s\n", name.c_str());
+      return false;
+    }
+    if (!io.attach(task->pipe)) {
+      ERROR_PRINT("Error: Could not listen on pipe %s\n", name.c_str());
+      CloseHandle(task->pipe);
+      return false;
+    }
+    if (!ConnectNamedPipe(task->pipe, task)) {
+      DWORD error = GetLastError();
+      if (error == ERROR_PIPE_CONNECTED) {
+        // The client connected before the wait began, so no completion is queued.
+        io.post(task);
+      }
+      else if (error != ERROR_IO_PENDING) {
+        ERROR_PRINT("Error: Could not listen on pipe %s\n", name.c_str());
+        CloseHandle(task->pipe);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Carries out a request on a worker thread and queues its response.
+   */
+  void answer(request_task *task) {
+    std::string content;
+    std::string error;
+    request_kind kind = REQUEST_OTHER;
+    if (task->operation == PIPE_RENDER || task->operation == PIPE_CREATE) {
+      kind = (task->operation == PIPE_RENDER) ? REQUEST_RENDER : REQUEST_CREATE;
+      std::shared_lock<std::shared_mutex> lock(config_mutex);
+      if (task->filename.empty()) {
+        error = "missing file";
+      }
+      else if (kind == REQUEST_RENDER) {
+        content = render_file_message(task->filename, get_file_extension(task->filename));
       }
       else {
-        file_message += line + "\n";
+        error = create_requested_file(fs, task->filename, (task->flags & PIPE_PARENTS) != 0,
+                                      (task->flags & PIPE_OVERWRITE) != 0);
       }
     }
+    else if (task->operation == PIPE_RELOAD) {
+      kind = REQUEST_RELOAD;
+      // Requests in progress finish with the old configuration first.
+      std::unique_lock<std::shared_mutex> lock(config_mutex);
+      load_config(probe_config(true), use_config_cache);
+      service_stats.config_reloads.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if (task->operation == PIPE_STATS) {
+      content = request_latencies.prometheus_text();
+    }
+    else {
+      error = "unknown operation";
+    }
+
+    const std::string &payload = error.empty() ? content : error;
+    uint32_t length = (uint32_t)(5 + payload.size());
+    std::string frame(9, '\0');
+    memcpy(&frame[0], &length, 4);
+    memcpy(&frame[4], &task->id, 4);
+    frame[8] = error.empty() ? 0 : 1;
+    frame += payload;
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - task->start);
+    request_latencies.record(kind, elapsed.count());
+    connection *client = task->client;
+    delete task;
+    client->respond(frame);
+  }
+
+  filesystem &fs;
+  bool use_config_cache;
+  std::string name;
+  std::shared_mutex config_mutex; /**< Held shared by renders and creates, exclusively by reloads. */
+  std::mutex mutex;               /**< Guards the listeners, the clients and stopping. */
+  std::condition_variable drained;
+  std::unordered_set<accept_task *> listeners;
+  std::unordered_set<connection *> connections;
+  bool stopping = false;
+  io_executor io;                 /**< Serves the pipe I/O of every client. */
+  io_executor workers;            /**< Carries out the requests. */
+};
+
+/**
+ * @brief Signaled by Ctrl+C to stop --serve-pipe.
+ */
+HANDLE serve_pipe_stop = NULL;
+
+BOOL WINAPI stop_serve_pipe(DWORD) {
+  SetEvent(serve_pipe_stop);
+  return TRUE;
+}
+
+/**
+ * @brief Runs touch as a server of the binary protocol of pipe_server until Ctrl+C.
+ *
+ * On Ctrl+C no new clients or requests are accepted, the requests already received are
+ * answered and every pipe is closed before the function returns.
+ *
+ * @param fs The filesystem backend for create requests.
+ * @param use_config_cache False to parse the configuration file on reload requests.
+ * @param name The name of the pipe, e.g. \\.\pipe\touch.
+ * @param jobs The number of workers carrying out requests.
+ * @return EXIT_FAILURE if the pipe couldn't be created.
+ */
+int serve_pipe(filesystem &fs, bool use_config_cache, const std::string &name, unsigned jobs) {
+  serve_pipe_stop = CreateEventA(NULL, TRUE, FALSE, NULL);
+  SetConsoleCtrlHandler(stop_serve_pipe, TRUE);
+  int status = EXIT_FAILURE;
+  {
+    pipe_server server(fs, use_config_cache, name, jobs);
+    if (server.start()) {
+      INFO_PRINT("touch: serving %s\n", name.c_str());
+      WaitForSingleObject(serve_pipe_stop, INFINITE);
+      status = EXIT_SUCCESS;
+    }
+    server.stop();
+  }
+  SetConsoleCtrlHandler(stop_serve_pipe, FALSE);
+  CloseHandle(serve_pipe_stop);
+  return status;
+}
+
+/**
+ * @brief Quotes an argument for a Windows command line, as CommandLineToArgvW parses it.
+ */
+std::string quote_argument(const std::string &argument) {
+  if (!argument.empty() && argument.find_first_of(" \t\"") == std::string::npos) return argument;
+  std::string out = "\"";
+  size_t backslashes = 0;
+  for (char c : argument) {
+    if (c == '\\') {
+      backslashes++;
+      continue;
+    }
+    // Backslashes are only special in front of a quote.
+    out.append(c == '"' ? backslashes * 2 + 1 : backslashes, '\\');
+    backslashes = 0;
+    out += c;
   }
+  out.append(backslashes * 2, '\\');
+  out += '"';
+  return out;
+}
 
-  // Write the message to the file.
-  FILE *file_out = nullptr;
-  if (fopen_s(&file_out, argv[1], "w") != 0 || file_out == nullptr) {
-    ERROR_PRINT("Error: Could not open file %s for writing\n", argv[1]);
+/**
+ * @brief Measures the cold-start latency of touch: the wall time from starting a touch
+ * process to its exit, over many runs, reported as percentiles.
+ *
+ * Every run creates one new file in a fresh temporary directory, as a developer typing
+ * touch FILE would, and the file is deleted again outside of the measured time. The
+ * first run isn't counted; it warms the file cache and publishes the compiled
+ * configuration like any earlier use of touch would have.
+ *
+ * Next to the wall time, the cycles and page faults of every run are read from its
+ * process handle, the counters Windows exposes without a kernel trace session.
+ *
+ * @param runs The number of measured runs.
+ * @param file_name The name of the file every run creates.
+ * @param options Further command-line options for every run, quoted and each preceded
+ *                by a space.
+ * @return EXIT_SUCCESS if every run succeeded.
+ */
+int bench_startup(unsigned runs, const std::string &file_name, const std::string &options) {
+  char exe[MAX_PATH];
+  char temp_directory[MAX_PATH + 1];
+  DWORD length = GetModuleFileNameA(NULL, exe, MAX_PATH);
+  if (length == 0 || length >= MAX_PATH || GetTempPathA(sizeof(temp_directory), temp_directory) == 0) {
+    ERROR_PRINT("Error: Could not locate touch or the temporary directory\n");
+    return EXIT_FAILURE;
+  }
+  std::string directory = std::string(temp_directory) + "touch-cold-start-" + std::to_string(GetCurrentProcessId());
+  if (!CreateDirectoryA(directory.c_str(), NULL)) {
+    ERROR_PRINT("Error: Could not create directory %s\n", directory.c_str());
     return EXIT_FAILURE;
   }
-  fprintf(file_out, "%s", file_message.c_str());
-  fclose(file_out);
+  std::string target = directory + "\\" + file_name;
+  std::string command = quote_argument(exe) + options + " " + quote_argument(target);
 
-  return EXIT_SUCCESS;
+  LARGE_INTEGER frequency;
+  QueryPerformanceFrequency(&frequency);
+  std::vector<unsigned long long> samples; // Microseconds.
+  std::vector<unsigned long long> cycle_samples;
+  std::vector<unsigned long long> fault_samples;
+  samples.reserve(runs);
+  int status = EXIT_SUCCESS;
+  for (unsigned run = 0; run <= runs; run++) {
+    STARTUPINFOA startup = {};
+    startup.cb = sizeof(startup);
+    PROCESS_INFORMATION process = {};
+    std::vector<char> command_line(command.begin(), command.end()); // CreateProcess may modify it.
+    command_line.push_back('\0');
+    LARGE_INTEGER start, end;
+    QueryPerformanceCounter(&start);
+    if (!CreateProcessA(exe, command_line.data(), NULL, NULL, FALSE, 0, NULL, NULL, &startup, &process)) {
+      ERROR_PRINT("Error: Could not start %s\n", exe);
+      status = EXIT_FAILURE;
+      break;
+    }
+    WaitForSingleObject(process.hProcess, INFINITE);
+    QueryPerformanceCounter(&end);
+    DWORD exit_code = EXIT_FAILURE;
+    GetExitCodeProcess(process.hProcess, &exit_code);
+    ULONG64 cycles;
+    PROCESS_MEMORY_COUNTERS memory;
+    bool have_cycles = QueryProcessCycleTime(process.hProcess, &cycles) != 0;
+    bool have_faults = GetProcessMemoryInfo(process.hProcess, &memory, sizeof(memory)) != 0;
+    CloseHandle(process.hThread);
+    CloseHandle(process.hProcess);
+    DeleteFileA(target.c_str());
+    if (exit_code != EXIT_SUCCESS) {
+      ERROR_PRINT("Error: Run %u of %s failed with exit code %lu\n", run, command.c_str(), (unsigned long)exit_code);
+      status = EXIT_FAILURE;
+      break;
+    }
+    if (run > 0) {
+      samples.push_back((unsigned long long)(end.QuadPart - start.QuadPart) * 1000000ULL / (unsigned long long)frequency.QuadPart);
+      if (have_cycles) cycle_samples.push_back(cycles);
+      if (have_faults) fault_samples.push_back(memory.PageFaultCount);
+    }
+  }
+  RemoveDirectoryA(directory.c_str());
+  if (samples.empty()) return status;
+
+  INFO_PRINT("touch: %zu cold starts of %s\n", samples.size(), command.c_str());
+  INFO_PRINT("  %-12s %10s %10s %10s %10s %10s %10s %10s\n", "", "min", "p50", "p90", "p99", "p99.9", "max", "mean");
+  auto print_row = [](const char *name, std::vector<unsigned long long> &values) {
+    if (values.empty()) {
+      INFO_PRINT("  %-12s %10s\n", name, "n/a");
+      return;
+    }
+    std::sort(values.begin(), values.end());
+    unsigned long long total = 0;
+    for (unsigned long long value : values) total += value;
+    // The nearest-rank percentile: the smallest value that at least per_mille of all are at or below.
+    auto percentile = [&](size_t per_mille) {
+      size_t rank = (values.size() * per_mille + 999) / 1000;
+      return values[(rank > 0) ? rank - 1 : 0];
+    };
+    INFO_PRINT("  %-12s %10llu %10llu %10llu %10llu %10llu %10llu %10llu\n", name, values.front(), percentile(500),
+               percentile(900), percentile(990), percentile(999), values.back(), total / values.size());
+  };
+  print_row("wall us", samples);
+  print_row("cycles", cycle_samples);
+  print_row("page faults", fault_samples);
+  return status;
 }
 
+/**
+ * @brief The main entry point for the touch command.
+ *
+ * This function processes command-line arguments, parses the configuration file and
+ * creates every requested file through the selected filesystem backend.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv Array of command-line argument strings.
+ * @return EXIT_SUCCESS if the program completes successfully, otherwise EXIT_FAILURE.
+ */
+int main(int argc, char *argv[]) {
+  // Declared first, so the provider is unregistered on every return from main.
+  trace_registration tracing;
+  std::vector<batch_input> inputs;
+  std::string fs_name = "native";
+  std::string tar_path;
+  std::string journal_path;
+  std::string rollback_path;
+  std::string manifest_path;
+  std::string counter_path;
+  bool to_stdout = false;
+  bool serve = false;
+  std::string pipe_name; // The pipe of --serve-pipe, empty if not given.
+  bool jobs_given = false;
+  bool use_config_cache = true;
+  unsigned startup_runs = 0;
+  std::string startup_options; // Every argument but the file names, for --bench-startup.
+  latency_model latency;
+  batch_options batch;
+
+  for (int i = 1; i < argc; i++) {
+    int first = i;
+    if (strcmp(argv[i], "--version") == 0) {
+      INFO_PRINT("touch %s\n", VERSION);
+      return EXIT_SUCCESS;
+    }
+    else if (strcmp(argv[i], "--help") == 0) {
+      print_help();
+      return EXIT_SUCCESS;
+    }
+    else if (strcmp(argv[i], "--emit-cpp") == 0) {
+      if (i + 1 >= argc) {
+        ERROR_PRINT("Error: --emit-cpp requires a configuration file\n");
+        return EXIT_FAILURE;
+      }
+      return emit_cpp(argv[i + 1]);
+    }
+    else if (strcmp(argv[i], "--emit-licenses") == 0) {
+      if (i + 1 >= argc) {
+        ERROR_PRINT("Error: --emit-licenses requires a directory\n");
+        return EXIT_FAILURE;
+      }
+      return emit_licenses(argv[i + 1]);
+    }
+    else if (strncmp(argv[i], "--fs=", 5) == 0) {
+      fs_name = argv[i] + 5;
+    }
+    else if (strncmp(argv[i], "--fs-latency=", 13) == 0) {
+      if (!parse_latency_model(argv[i] + 13, &latency)) {
+        ERROR_PRINT("Error: Invalid latency specification %s\n", argv[i] + 13);
+        return EXIT_FAILURE;
+      }
+    }
+    else if (strncmp(argv[i], "--output-tar=", 13) == 0) {
+      tar_path = argv[i] + 13;
+      fs_name = "tar";
+    }
+    else if (strcmp(argv[i], "-j") == 0 || strncmp(argv[i], "--jobs=", 7) == 0) {
+      const char *jobs = (argv[i][1] == 'j') ? ((i + 1 < argc) ? argv[++i] : "") : argv[i] + 7;
+      jobs_given = true;
+      if (strcmp(jobs, "auto") == 0) {
+        batch.adaptive = true;
+        batch.jobs = AUTO_MAX_JOBS;
+      }
+      else {
+        batch.adaptive = false;
+        batch.jobs = (unsigned)strtoul(jobs, nullptr, 10);
+        if (batch.jobs == 0) {
+          ERROR_PRINT("Error: Invalid number of jobs %s\n", jobs);
+          return EXIT_FAILURE;
+        }
+      }
+    }
+    else if (strncmp(argv[i], "--files-from=", 13) == 0) {
+      inputs.push_back({argv[i] + 13, true});
+      stdin_file_list = stdin_file_list || strcmp(argv[i] + 13, "-") == 0;
+    }
+    else if (strcmp(argv[i], "--timings") == 0 || strcmp(argv[i], "--timings=hw") == 0) {
+      batch.timings = true;
+      hw_timings = argv[i][9] == '=';
+    }
+    else if (strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "--parents") == 0) {
+      batch.parents = true;
+    }
+    else if (strcmp(argv[i], "--async") == 0 || strncmp(argv[i], "--async=", 8) == 0) {
+#if defined(__cpp_impl_coroutine)
+      batch.async_in_flight = (argv[i][7] == '=') ? (unsigned)strtoul(argv[i] + 8, nullptr, 10) : ASYNC_DEFAULT_IN_FLIGHT;
+      if (batch.async_in_flight == 0) {
+        ERROR_PRINT("Error: Invalid number of files in flight %s\n", argv[i] + 8);
+        return EXIT_FAILURE;
+      }
+#else
+      ERROR_PRINT("Error: --async requires touch to be built with C++20 coroutine support\n");
+      return EXIT_FAILURE;
+#endif
+    }
+    else if (strcmp(argv[i], "--transaction") == 0 || strncmp(argv[i], "--transaction=", 14) == 0) {
+      journal_path = (argv[i][13] == '=') ? argv[i] + 14 : DEFAULT_JOURNAL;
+    }
+    else if (strncmp(argv[i], "--rollback=", 11) == 0) {
+      rollback_path = argv[i] + 11;
+    }
+    else if (strncmp(argv[i], "--size=", 7) == 0) {
+      if (!parse_size(argv[i] + 7, &batch.payload.size)) {
+        ERROR_PRINT("Error: Invalid size %s\n", argv[i] + 7);
+        return EXIT_FAILURE;
+      }
+    }
+    else if (strncmp(argv[i], "--fill=", 7) == 0) {
+      if (!parse_fill_mode(argv[i] + 7, &batch.payload.fill)) {
+        ERROR_PRINT("Error: Unknown fill mode %s\n", argv[i] + 7);
+        return EXIT_FAILURE;
+      }
+    }
+    else if (strncmp(argv[i], "--manifest=", 11) == 0) {
+      manifest_path = argv[i] + 11;
+    }
+    else if (strncmp(argv[i], "--counter=", 10) == 0) {
+      counter_path = argv[i] + 10;
+    }
+    else if (strcmp(argv[i], "--stdout") == 0) {
+      to_stdout = true;
+    }
+    else if (strcmp(argv[i], "--serve-stdio") == 0) {
+      serve = true;
+    }
+    else if (strcmp(argv[i], "--serve-pipe") == 0 || strncmp(argv[i], "--serve-pipe=", 13) == 0) {
+      pipe_name = (argv[i][12] == '=') ? argv[i] + 13 : PIPE_NAME;
+      if (pipe_name.compare(0, 9, "\\\\.\\pipe\\") != 0) {
+        pipe_name = "\\\\.\\pipe\\" + pipe_name;
+      }
+    }
+    else if (strcmp(argv[i], "--no-config-cache") == 0) {
+      use_config_cache = false;
+    }
+    else if (strcmp(argv[i], "--trace") == 0) {
+      // Registering only publishes the provider; events stay disabled until a session enables them.
+      tracing.enable();
+    }
+    else if (strncmp(argv[i], "--bench-startup=", 16) == 0) {
+      startup_runs = (unsigned)strtoul(argv[i] + 16, nullptr, 10);
+      if (startup_runs == 0) {
+        ERROR_PRINT("Error: Invalid number of runs %s\n", argv[i] + 16);
+        return EXIT_FAILURE;
+      }
+      continue;
+    }
+    else {
+      inputs.push_back({argv[i], false});
+      continue;
+    }
+    for (int j = first; j <= i; j++) {
+      startup_options += " " + quote_argument(argv[j]);
+    }
+  }
+
+  if (startup_runs > 0) {
+    if (inputs.size() > 1 || (!inputs.empty() && inputs[0].is_list)) {
+      ERROR_PRINT("Error: --bench-startup takes a single file name\n");
+      return EXIT_FAILURE;
+    }
+    return bench_startup(startup_runs, inputs.empty() ? "cold-start.c" : inputs[0].value, startup_options);
+  }
+
+  if ((serve || !pipe_name.empty()) && (!tar_path.empty() || !journal_path.empty() || !manifest_path.empty())) {
+    // A server has no end of batch at which an archive, a journal or a manifest is completed.
+    ERROR_PRINT("Error: --serve-stdio and --serve-pipe can't be combined with --output-tar, --transaction or --manifest\n");
+    return EXIT_FAILURE;
+  }
+
+  if (batch.payload.size > 0 && batch.async_in_flight > 0) {
+    // Writing a payload is bound by bandwidth, not by the number of files in flight.
+    ERROR_PRINT("Error: --size can't be combined with --async\n");
+    return EXIT_FAILURE;
+  }
+
+  if (inputs.empty() && rollback_path.empty() && !serve) {
+    ERROR_PRINT("Error: No file name provided\n");
+    print_help();
+    return EXIT_FAILURE;
+  }
+
+  std::unique_ptr<filesystem> fs;
+  tar_filesystem *tar_fs = nullptr;
+  if (fs_name == "native") {
+    fs.reset(new native_filesystem());
+  }
+  else if (fs_name == "memory") {
+    fs.reset(new memory_filesystem(latency));
+  }
+  else if (fs_name == "tar") {
+    HANDLE out;
+    if (tar_path == "-") {
+      out = GetStdHandle(STD_OUTPUT_HANDLE);
+    }
+    else {
+      out = CreateFileA(tar_path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL,
+                        CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    }
+    if (out == INVALID_HANDLE_VALUE || out == NULL) {
+      ERROR_PRINT("Error: Could not open tar output %s\n", tar_path.c_str());
+      return EXIT_FAILURE;
+    }
+    tar_fs = new tar_filesystem(out, tar_path != "-");
+    fs.reset(tar_fs);
+  }
+  else {
+    ERROR_PRINT("Error: Unknown filesystem backend %s\n", fs_name.c_str());
+    return EXIT_FAILURE;
+  }
+
+  if (!rollback_path.empty()) {
+    std::vector<journal_record> records;
+    if (!read_journal(rollback_path, &records)) {
+      ERROR_PRINT("Error: Could not read journal %s\n", rollback_path.c_str());
+      return EXIT_FAILURE;
+    }
+    if (rollback_journal(*fs, records, rollback_path + ".d") != 0) {
+      return EXIT_FAILURE;
+    }
+    fs->remove(rollback_path);
+    INFO_PRINT("touch: rolled back %zu changes\n", records.size());
+    return EXIT_SUCCESS;
+  }
+
+  // Parse configuration file from the executable's directory.
+  load_config(probe_config(), use_config_cache);
+
+  if (!counter_path.empty() && !sequence.open(counter_path)) {
+    return EXIT_FAILURE;
+  }
+  if (serve || !pipe_name.empty()) {
+    // Without -j the server uses a worker per processor.
+    unsigned jobs = jobs_given ? batch.jobs : std::max(1u, std::thread::hardware_concurrency());
+    int status = serve ? serve_stdio(*fs, use_config_cache) : serve_pipe(*fs, use_config_cache, pipe_name, jobs);
+    finish_plugins();
+    if (!sequence.finish(true)) {
+      ERROR_PRINT("Error: Could not write counter file %s\n", counter_path.c_str());
+      status = EXIT_FAILURE;
+    }
+    return status;
+  }
+  if (to_stdout) {
+    // Render only, nothing is created.
+    int status = EXIT_SUCCESS;
+    bool read_ok = for_each_target(inputs, [&](const std::string &filename) {
+      if (!write_stdout(render_file_message(filename, get_file_extension(filename)))) {
+        status = EXIT_FAILURE;
+      }
+    });
+    finish_plugins();
+    if (hw_timings) print_phase_counters();
+    if (!sequence.finish(true)) {
+      ERROR_PRINT("Error: Could not write counter file %s\n", counter_path.c_str());
+      status = EXIT_FAILURE;
+    }
+    return read_ok ? status : EXIT_FAILURE;
+  }
+
+  // In a transaction every change goes through the journal, so it can be undone.
+  std::unique_ptr<journaled_filesystem> journal_fs;
+  filesystem *target = fs.get();
+  if (!journal_path.empty()) {
+    if (tar_fs != nullptr) {
+      ERROR_PRINT("Error: --transaction can't be combined with --output-tar\n");
+      return EXIT_FAILURE;
+    }
+    journal_fs.reset(new journaled_filesystem(*fs, journal_path));
+    if (!journal_fs->begin()) {
+      return EXIT_FAILURE;
+    }
+    target = journal_fs.get();
+  }
+
+  // The manifest sees the files as they are written, on top of any journal.
+  std::unique_ptr<manifest_filesystem> manifest_fs;
+  if (!manifest_path.empty()) {
+    HANDLE manifest_out;
+    if (manifest_path == "-") {
+      if (tar_fs != nullptr && tar_path == "-") {
+        ERROR_PRINT("Error: --manifest=- and --output-tar=- can't both write to stdout\n");
+        return EXIT_FAILURE;
+      }
+      manifest_out = GetStdHandle(STD_OUTPUT_HANDLE);
+    }
+    else {
+      manifest_out = CreateFileA(manifest_path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL,
+                                 CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    }
+    if (manifest_out == INVALID_HANDLE_VALUE || manifest_out == NULL) {
+      ERROR_PRINT("Error: Could not open manifest %s\n", manifest_path.c_str());
+      return EXIT_FAILURE;
+    }
+    manifest_fs.reset(new manifest_filesystem(*target, manifest_out, manifest_path != "-"));
+    target = manifest_fs.get();
+  }
+
+  int status = EXIT_SUCCESS;
+  if (batch.adaptive || batch.jobs > 1 || batch.timings || batch.async_in_flight > 0) {
+    if (!run_batch(*target, inputs, batch)) {
+      status = EXIT_FAILURE;
+    }
+  }
+  else {
+    bool read_ok = for_each_target(inputs, [&](const std::string &filename) {
+      if (create_file(*target, filename, batch.parents, batch.payload) == CREATE_FAILED) {
+        status = EXIT_FAILURE;
+      }
+    });
+    if (!read_ok) {
+      status = EXIT_FAILURE;
+    }
+  }
+
+  if (manifest_fs && !manifest_fs->finish()) {
+    ERROR_PRINT("Error: Could not write manifest %s\n", manifest_path.c_str());
+    status = EXIT_FAILURE;
+  }
+
+  finish_plugins();
+  if (hw_timings) print_phase_counters();
+
+  // A rolled back transaction leaves the numbers it used to the next run.
+  bool rolled_back = journal_fs && status != EXIT_SUCCESS;
+  if (!sequence.finish(!rolled_back)) {
+    ERROR_PRINT("Error: Could not write counter file %s\n", counter_path.c_str());
+    status = EXIT_FAILURE;
+  }
+
+  if (journal_fs) {
+    if (status == EXIT_SUCCESS) {
+      if (!journal_fs->commit()) {
+        ERROR_PRINT("Error: Could not remove journal %s\n", journal_path.c_str());
+        status = EXIT_FAILURE;
+      }
+    }
+    else {
+      size_t changes = journal_fs->change_count();
+      if (journal_fs->rollback() == 0) {
+        ERROR_PRINT("touch: transaction failed, rolled back %zu changes\n", changes);
+        // None of the files in the manifest exist anymore.
+        if (manifest_fs && manifest_path != "-") DeleteFileA(manifest_path.c_str());
+      }
+      else {
+        ERROR_PRINT("Error: Rollback incomplete, finish it with --rollback=%s\n", journal_path.c_str());
+      }
+    }
+  }
+
+  if (tar_fs != nullptr && !tar_fs->finish()) {
+    ERROR_PRINT("Error: Could not write tar output %s\n", tar_path.c_str());
+    status = EXIT_FAILURE;
+  }
+
+  return status;
+}
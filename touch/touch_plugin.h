@@ -0,0 +1,96 @@
+/**
+ * @file touch_plugin.h
+ * @brief The C interface of touch plugins.
+ *
+ * A plugin is a DLL that provides placeholders, e.g. a <ticket> looked up in a local
+ * cache. The configuration names the DLL and its placeholders:
+ *
+ *   PLUGIN "plugins\tickets.dll" ticket
+ *
+ * touch only loads the DLL once a file is rendered with one of them. It then calls the
+ * exported touch_plugin_init(), which registers a provider for each placeholder with
+ * register_provider(). Every hook of a provider is optional except evaluate.
+ *
+ * The interface is plain C and only ever grows at the end of its structures, so plugins
+ * built against an older version keep working. Check abi_version before using a member
+ * added after version 1.
+ */
+
+#ifndef TOUCH_PLUGIN_H
+#define TOUCH_PLUGIN_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TOUCH_PLUGIN_ABI_VERSION 1
+
+/**
+ * @brief A placeholder provided by a plugin.
+ */
+typedef struct touch_provider {
+  /** The placeholder without brackets, e.g. "ticket" for <ticket> and <ticket:ARG>. */
+  const char *name;
+
+  /** Context passed to begin_run. */
+  void *context;
+
+  /**
+   * Called once per run, before the first file is evaluated. Returns the state passed
+   * to evaluate and end_run; a null pointer is a valid state. May be null.
+   */
+  void *(*begin_run)(void *context);
+
+  /**
+   * Called once per file and placeholder, possibly from several threads at once.
+   *
+   * @param state The state returned by begin_run.
+   * @param path The path of the file being created, as given on the command line.
+   * @param argument The text after the colon of <name:ARG>, or "" for <name>.
+   * @param buffer Receives the value, which needs no terminating NUL. The value must be a
+   *               single line: it is rendered inside a comment, so touch replaces line
+   *               breaks (every run of CR and LF characters) by a space.
+   * @param length Holds the size of buffer and receives the length of the value. If the
+   *               value is longer than the buffer, evaluate is called again with a buffer
+   *               of at least that size.
+   * @return 0 on success; anything else renders an empty value.
+   */
+  int (*evaluate)(void *state, const char *path, const char *argument, char *buffer, size_t *length);
+
+  /** Called once when the run ends, if begin_run was called. May be null. */
+  void (*end_run)(void *state);
+} touch_provider;
+
+/**
+ * @brief The functions touch offers a plugin.
+ */
+typedef struct touch_host {
+  /** TOUCH_PLUGIN_ABI_VERSION of the touch that loaded the plugin. */
+  unsigned abi_version;
+
+  /** Opaque to the plugin. */
+  void *host;
+
+  /**
+   * Registers a provider. The structure is copied, its strings must stay valid while
+   * the plugin is loaded. Returns 0 on success.
+   */
+  int (*register_provider)(void *host, const touch_provider *provider);
+
+  /** Prints an error message on behalf of the plugin. */
+  void (*log_error)(void *host, const char *message);
+} touch_host;
+
+/**
+ * @brief The function every plugin exports as touch_plugin_init.
+ * @return 0 on success; anything else unloads the plugin.
+ */
+typedef int (*touch_plugin_init_function)(const touch_host *host);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TOUCH_PLUGIN_H */